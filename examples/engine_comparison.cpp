@@ -0,0 +1,112 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include "epideux/epideux.h"
+
+using namespace epideux;
+using namespace std::chrono_literals;
+
+// Households of four people. Every day the people go to one of the schools
+// in the morning, and half of them visit the shop in the afternoon.
+void buildScenario(Model& sim_model, int num_households, int sim_days,
+                   double beta) {
+  sim_model.setStartDate(2020, 4, 1);
+  int num_schools = num_households / 100 + 1;
+  std::vector<Location*> schools;
+  for (int i = 0; i < num_schools; ++i) {
+    std::stringstream ss;
+    ss << "School" << i;
+    schools.push_back(&sim_model.createLocation(beta, ss.str()));
+  }
+  Location& shop = sim_model.createLocation(beta, "Shop");
+
+  time_pt day0 = sim_model.currentTime();
+  for (int h = 0; h < num_households; ++h) {
+    Location& home = sim_model.createLocation(beta);
+    Location& school = *schools[h % num_schools];
+    for (int i = 0; i < 4; ++i) {
+      Person& person = sim_model.createPerson(home, 4*24h, 5*24h);
+      for (int d = 0; d < sim_days; ++d) {
+        time_pt day = day0 + d*24h;
+        person.addItineraryEntry(ItineraryEntry(school, day + 8h, day + 15h));
+        if (i % 2 == 0) {
+          person.addItineraryEntry(ItineraryEntry(shop, day + 16h, day + 17h));
+        }
+      }
+    }
+  }
+  sim_model.getPerson(0).infect();
+}
+
+void printReport(const char* engine, double seconds, SeirReport r) {
+  std::cout << engine << ": " << seconds << " s,";
+  for (size_t i = 0; i < DiseaseModel::num_states; ++i) {
+    std::cout << ' ' << DiseaseModel::state_names[i][0] << ": "
+              << reportCount(r, i);
+  }
+  std::cout << std::endl;
+}
+
+int main(int argc, char const *argv[]) {
+  if (argc != 4) {
+    std::cout << "Please provide [number of households] [beta] [simulation days]"
+              << std::endl;
+    return -1;
+  }
+  int num_households = std::atoi(argv[1]);
+  double beta = std::atof(argv[2]);
+  int sim_days = std::atoi(argv[3]);
+
+  {
+    Model sim_model;
+    buildScenario(sim_model, num_households, sim_days, beta);
+    auto start = std::chrono::steady_clock::now();
+    sim_model.simulate(24h*sim_days);
+    auto end = std::chrono::steady_clock::now();
+    std::chrono::duration<double> sim_time(end-start);
+    printReport("Event engine", sim_time.count(), sim_model.getReport());
+  }
+
+  {
+    Model sim_model;
+    sim_model.setTransmissionModel(TransmissionModel::ExposureAccumulation);
+    buildScenario(sim_model, num_households, sim_days, beta);
+    auto start = std::chrono::steady_clock::now();
+    sim_model.simulate(24h*sim_days);
+    auto end = std::chrono::steady_clock::now();
+    std::chrono::duration<double> sim_time(end-start);
+    printReport("Event engine (exposure accumulation)", sim_time.count(),
+                sim_model.getReport());
+  }
+
+  for (auto time_step : {15min, 60min}) {
+    Model sim_model;
+    buildScenario(sim_model, num_households, sim_days, beta);
+    auto start = std::chrono::steady_clock::now();
+    sim_model.simulateFixedStep(24h*sim_days, time_step);
+    auto end = std::chrono::steady_clock::now();
+    std::chrono::duration<double> sim_time(end-start);
+    std::stringstream ss;
+    ss << "Fixed-step engine (" << time_step.count() << " min)";
+    printReport(ss.str().c_str(), sim_time.count(), sim_model.getReport());
+  }
+
+  return 0;
+}
@@ -0,0 +1,104 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <sys/resource.h>
+
+#include <cstdlib>
+#include <iostream>
+#include "epideux/epideux.h"
+
+using namespace epideux;
+using namespace std::chrono_literals;
+
+// Households of four people commuting to workplaces of fifty every day, so
+// the itineraries dominate the memory.
+void buildScenario(Model& sim_model, int num_households, int sim_days) {
+  sim_model.setStartDate(2020, 4, 1);
+  int num_workplaces = num_households * 4 / 50 + 1;
+  std::vector<Location*> workplaces;
+  for (int i = 0; i < num_workplaces; ++i) {
+    workplaces.push_back(&sim_model.createLocation(0.3));
+  }
+
+  // Homes are built one at a time, so a household and its itineraries are
+  // neighbours in the person storage.
+  time_pt day0 = sim_model.currentTime();
+  for (int h = 0; h < num_households; ++h) {
+    Location& home = sim_model.createLocation(0.5);
+    for (int i = 0; i < 4; ++i) {
+      Person& person = sim_model.createPerson(home, 4*24h, 5*24h);
+      Location& work = *workplaces[(4 * h + i) % num_workplaces];
+      for (int d = 0; d < sim_days; ++d) {
+        time_pt day = day0 + d*24h;
+        person.addItineraryEntry(ItineraryEntry(work, day + 8h, day + 16h));
+      }
+    }
+  }
+  sim_model.getPerson(0).infect();
+}
+
+double peakResidentMb() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss / 1024.0;
+}
+
+double run(const char* storage_path, int num_households, int sim_days) {
+  Model sim_model;
+  if (storage_path) {
+    sim_model.mapPersonStorage(storage_path, size_t(64) << 30);
+    sim_model.personStorage().advise(MappedStorage::Advice::Sequential);
+  }
+  auto start = std::chrono::steady_clock::now();
+  buildScenario(sim_model, num_households, sim_days);
+  sim_model.personStorage().advise(MappedStorage::Advice::Random);
+  auto built = std::chrono::steady_clock::now();
+  sim_model.simulate(sim_days*24h);
+  auto done = std::chrono::steady_clock::now();
+
+  double build_seconds = std::chrono::duration<double>(built - start).count();
+  double sim_seconds = std::chrono::duration<double>(done - built).count();
+  // Every itinerary entry is two events.
+  double events = 2.0 * 4 * num_households * sim_days;
+  std::cout << (storage_path ? "mapped" : "in memory") << ": build "
+            << build_seconds << " s, simulate " << sim_seconds << " s, "
+            << events / sim_seconds << " events/s, file "
+            << sim_model.personStorage().used() / (1024.0 * 1024.0)
+            << " MB, peak resident " << peakResidentMb() << " MB, recovered "
+            << sim_model.getReport().recovered << std::endl;
+  return sim_seconds;
+}
+
+int main(int argc, char const *argv[]) {
+  if (argc != 4) {
+    std::cout << "Please provide [number of households] [simulation days] "
+                 "[storage file]"
+              << std::endl;
+    return -1;
+  }
+  int num_households = std::atoi(argv[1]);
+  int sim_days = std::atoi(argv[2]);
+
+  // The peak resident size only grows, so the mapped run goes first.
+  double mapped = run(argv[3], num_households, sim_days);
+  double in_memory = run(nullptr, num_households, sim_days);
+  std::cout << "Mapped storage costs " << (mapped / in_memory - 1.0) * 100
+            << " % in simulation time" << std::endl;
+
+  return 0;
+}
@@ -16,6 +16,7 @@ int main(int argc, char const *argv[]) {
   using namespace std::chrono_literals;
 
   Model sim_model;
+  sim_model.setLogger(spdlog::default_logger());
   sim_model.setStartDate(2020, 4, 1);
 
   double num_agents = 5;
@@ -0,0 +1,219 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace epideux {
+
+// A timed transition out of a compartment. When the person has spent the
+// duration with the given index in the compartment, the person moves on to
+// the next compartment. Compartments without a timed exit have the duration
+// kNoTransition.
+template <typename State>
+struct Transition {
+  State next;
+  int duration;
+};
+
+constexpr int kNoTransition = -1;
+
+typedef std::chrono::system_clock::duration disease_duration;
+
+// Susceptible, Infectious, Recovered.
+struct Sir {
+  enum class State : uint8_t { Susceptible, Infectious, Recovered };
+  enum DurationIndex { Disease, NumDurations };
+  static constexpr size_t num_states = 3;
+  typedef std::array<disease_duration, NumDurations> Durations;
+
+  struct Report {
+    uint32_t susceptible = 0;
+    uint32_t infectious = 0;
+    uint32_t recovered = 0;
+  };
+
+  static constexpr uint32_t Report::*report_fields[num_states] = {
+      &Report::susceptible, &Report::infectious, &Report::recovered};
+  static constexpr const char* state_names[num_states] = {
+      "Susceptible", "Infectious", "Recovered"};
+  static constexpr bool susceptible[num_states] = {true, false, false};
+  static constexpr bool infectious[num_states] = {false, true, false};
+  static constexpr State infected_state = State::Infectious;
+  static constexpr Transition<State> transitions[num_states] = {
+      {State::Susceptible, kNoTransition},
+      {State::Recovered, Disease},
+      {State::Recovered, kNoTransition}};
+
+  static Durations makeDurations(disease_duration /* incubation_time */,
+                                 disease_duration disease_time) {
+    return {disease_time};
+  }
+};
+
+// Susceptible, Exposed, Infectious, Recovered.
+struct Seir {
+  enum class State : uint8_t { Susceptible, Exposed, Infectious, Recovered };
+  enum DurationIndex { Incubation, Disease, NumDurations };
+  static constexpr size_t num_states = 4;
+  typedef std::array<disease_duration, NumDurations> Durations;
+
+  struct Report {
+    uint32_t susceptible = 0;
+    uint32_t exposed = 0;
+    uint32_t infectious = 0;
+    uint32_t recovered = 0;
+  };
+
+  static constexpr uint32_t Report::*report_fields[num_states] = {
+      &Report::susceptible, &Report::exposed, &Report::infectious,
+      &Report::recovered};
+  static constexpr const char* state_names[num_states] = {
+      "Susceptible", "Exposed", "Infectious", "Recovered"};
+  static constexpr bool susceptible[num_states] = {true, false, false, false};
+  static constexpr bool infectious[num_states] = {false, false, true, false};
+  static constexpr State infected_state = State::Exposed;
+  static constexpr Transition<State> transitions[num_states] = {
+      {State::Susceptible, kNoTransition},
+      {State::Infectious, Incubation},
+      {State::Recovered, Disease},
+      {State::Recovered, kNoTransition}};
+
+  static Durations makeDurations(disease_duration incubation_time,
+                                 disease_duration disease_time) {
+    return {incubation_time, disease_time};
+  }
+};
+
+// SEIR where the immunity wanes, so recovered people become susceptible
+// again. An immunity time of disease_duration::max() means lifelong immunity.
+struct Seirs {
+  enum class State : uint8_t { Susceptible, Exposed, Infectious, Recovered };
+  enum DurationIndex { Incubation, Disease, Immunity, NumDurations };
+  static constexpr size_t num_states = 4;
+  typedef std::array<disease_duration, NumDurations> Durations;
+
+  typedef Seir::Report Report;
+
+  static constexpr uint32_t Report::*report_fields[num_states] = {
+      &Report::susceptible, &Report::exposed, &Report::infectious,
+      &Report::recovered};
+  static constexpr const char* state_names[num_states] = {
+      "Susceptible", "Exposed", "Infectious", "Recovered"};
+  static constexpr bool susceptible[num_states] = {true, false, false, false};
+  static constexpr bool infectious[num_states] = {false, false, true, false};
+  static constexpr State infected_state = State::Exposed;
+  static constexpr Transition<State> transitions[num_states] = {
+      {State::Susceptible, kNoTransition},
+      {State::Infectious, Incubation},
+      {State::Recovered, Disease},
+      {State::Susceptible, Immunity}};
+
+  static Durations makeDurations(disease_duration incubation_time,
+                                 disease_duration disease_time) {
+    return {incubation_time, disease_time, disease_duration::max()};
+  }
+};
+
+// SEIR with hospitalization after the infectious period. A hospital time of
+// zero means the person recovers without being hospitalized. Hospitalized
+// people are isolated and do not infect others.
+struct Seihr {
+  enum class State : uint8_t {
+    Susceptible,
+    Exposed,
+    Infectious,
+    Hospitalized,
+    Recovered
+  };
+  enum DurationIndex { Incubation, Disease, Hospital, NumDurations };
+  static constexpr size_t num_states = 5;
+  typedef std::array<disease_duration, NumDurations> Durations;
+
+  struct Report {
+    uint32_t susceptible = 0;
+    uint32_t exposed = 0;
+    uint32_t infectious = 0;
+    uint32_t hospitalized = 0;
+    uint32_t recovered = 0;
+  };
+
+  static constexpr uint32_t Report::*report_fields[num_states] = {
+      &Report::susceptible, &Report::exposed, &Report::infectious,
+      &Report::hospitalized, &Report::recovered};
+  static constexpr const char* state_names[num_states] = {
+      "Susceptible", "Exposed", "Infectious", "Hospitalized", "Recovered"};
+  static constexpr bool susceptible[num_states] = {true, false, false, false,
+                                                   false};
+  static constexpr bool infectious[num_states] = {false, false, true, false,
+                                                  false};
+  static constexpr State infected_state = State::Exposed;
+  static constexpr Transition<State> transitions[num_states] = {
+      {State::Susceptible, kNoTransition},
+      {State::Infectious, Incubation},
+      {State::Hospitalized, Disease},
+      {State::Recovered, Hospital},
+      {State::Recovered, kNoTransition}};
+
+  static Durations makeDurations(disease_duration incubation_time,
+                                 disease_duration disease_time) {
+    return {incubation_time, disease_time, disease_duration::zero()};
+  }
+};
+
+// The disease model is chosen at build time through the
+// EPIDEUX_DISEASE_MODEL CMake option, so the engine only carries the
+// compartments it uses.
+#if defined(EPIDEUX_DISEASE_MODEL_SIR)
+typedef Sir DiseaseModel;
+#elif defined(EPIDEUX_DISEASE_MODEL_SEIRS)
+typedef Seirs DiseaseModel;
+#elif defined(EPIDEUX_DISEASE_MODEL_SEIHR)
+typedef Seihr DiseaseModel;
+#else
+typedef Seir DiseaseModel;
+#endif
+
+typedef DiseaseModel::State InfectionCategory;
+typedef DiseaseModel::Report SeirReport;
+typedef DiseaseModel::Durations DiseaseDurations;
+
+constexpr size_t stateIndex(InfectionCategory state) {
+  return static_cast<size_t>(state);
+}
+
+constexpr bool isSusceptible(InfectionCategory state) {
+  return DiseaseModel::susceptible[stateIndex(state)];
+}
+
+constexpr bool isInfectious(InfectionCategory state) {
+  return DiseaseModel::infectious[stateIndex(state)];
+}
+
+inline uint32_t& reportCount(SeirReport& report, InfectionCategory state) {
+  return report.*DiseaseModel::report_fields[stateIndex(state)];
+}
+
+inline uint32_t reportCount(const SeirReport& report, size_t state_index) {
+  return report.*DiseaseModel::report_fields[state_index];
+}
+
+}  // namespace epideux
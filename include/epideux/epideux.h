@@ -19,58 +19,118 @@
 
 #include <chrono>
 #include <cstdint>
-#include <deque>
-#include <functional>
 #include <list>
 #include <memory>
+#include <memory_resource>
 #include <random>
 #include <string>
 #include <utility>
 #include <vector>
 
-#include "spdlog/sinks/basic_file_sink.h"
+#include "epideux/disease_model.h"
+#include "epideux/fenwick_tree.h"
+#include "epideux/mapped_storage.h"
+#include "epideux/memory_report.h"
+#include "epideux/model_stats.h"
+#include "epideux/random.h"
+
+namespace spdlog {
+class logger;
+}  // namespace spdlog
 
 namespace epideux {
 
 // Forward Declerations
 class Person;
 class Model;
+class ReportSink;
+class LocationRecorder;
+class EventTrace;
+class TransmissionLog;
+class HardwareCounters;
+class StatsPage;
+enum class TraceEventKind : uint8_t;
 
 typedef std::chrono::time_point<std::chrono::system_clock> time_pt;
 typedef std::chrono::system_clock::duration time_duration;
 
-enum class InfectionCategory { Susceptible, Exposed, Infectious, Recovered };
+enum class TransmissionModel { Binomial, ExposureAccumulation };
 
-struct SeirReport {
-  uint32_t susceptible = 0;
-  uint32_t exposed = 0;
-  uint32_t infectious = 0;
-  uint32_t recovered = 0;
+// The kinds of events in the model's schedule. The events are plain data, so
+// the schedule can be written to a checkpoint.
+enum class ScheduledEvent : uint8_t {
+  Report,
+  Stop,
+  BeginItineraryEntry,
+  EndItineraryEntry,
+  NumEvents
 };
 
+static_assert(static_cast<size_t>(ScheduledEvent::NumEvents) ==
+                  kNumScheduledEvents,
+              "The stats count every kind of scheduled event");
+
 typedef std::vector<SeirReport> SeirTimeline;
 
+// A view of reports kept by the model.
+struct ReportSpan {
+  const SeirReport* data;
+  size_t size;
+  const SeirReport* begin() const { return data; }
+  const SeirReport* end() const { return data + size; }
+  const SeirReport& operator[](size_t i) const { return data[i]; }
+};
+
 class Location {
  public:
-  Location(Model& simulation_model, double beta, std::string name);
+  Location(Model& simulation_model, uint32_t id, double beta,
+           std::string name);
   Location(const Location&) = delete;
   Location& operator=(const Location&) = delete;
   Location(Location&&) = delete;
   Location& operator=(Location&&) = delete;
-  const std::list<Person*>& getPersons() const;
+  const std::pmr::list<Person*>& getPersons() const;
   void updateInfections();
-  std::function<void()> enter(Person& new_person);
-  void leave(std::list<Person*>::iterator& leaving_person_it);
+  void infectSusceptibles(double prob_of_infection);
+  void infectWeighted(uint32_t num_infected);
+  std::pmr::list<Person*>::iterator enter(Person& new_person);
+  void leave(std::pmr::list<Person*>::iterator leaving_person_it);
+  void addContribution(const Person& person);
+  void removeContribution(const Person& person);
   SeirReport collectSeir();
+  const SeirReport& counts() const;
+  void markChanged();
+  void clearChanged();
+  uint32_t numSusceptible() const;
+  double infectiousWeight() const;
+  double susceptibilityWeight() const;
+  double infectiousPressure();
   void setBeta(double new_beta);
+  double betaPerSecond() const;
   std::string name();
+  uint32_t id() const;
 
  private:
+  friend class Model;
   Model& model_;
+  uint32_t id_;
   std::string name_;
-  std::list<Person*> persons_;
+  std::pmr::list<Person*> persons_;
   time_pt last_update_;
   double beta_per_sec_;
+  SeirReport counts_;
+  bool changed_ = false;
+  uint32_t num_susceptible_ = 0;
+  uint32_t num_infectious_ = 0;
+  double pressure_integral_ = 0.0;
+  time_pt last_pressure_update_;
+  void advancePressure();
+  void settleExposure(Person& person);
+  FenwickTree susceptibility_tree_;
+  FenwickTree infectiousness_tree_;
+  void transmit(Person& victim);
+  std::vector<Person*> slot_persons_;
+  std::vector<uint32_t> free_slots_;
 };
 
 class ItineraryEntry {
@@ -88,29 +148,45 @@ class ItineraryEntry {
 class Person {
  public:
   Person(Model& simulation_model, uint32_t id, Location& home,
-         time_duration incubation_time, time_duration disease_time);
+         const DiseaseDurations& durations);
   Person(const Person&) = delete;
   Person& operator=(const Person&) = delete;
   Person(Person&&) = delete;
   Person& operator=(Person&&) = delete;
   void addItineraryEntry(ItineraryEntry new_entry);
+  void sortItinerary();
   void infect();
   void updateInfection();
   InfectionCategory infectionState();
   uint32_t id() const;
+  Location& currentLocation() const;
+  Location& home() const;
+  const std::pmr::list<ItineraryEntry>& itinerary() const;
+  const DiseaseDurations& durations() const;
+  void setInfectiousness(double infectiousness);
+  void setSusceptibility(double susceptibility);
+  double infectiousness() const;
+  double susceptibility() const;
 
  private:
+  friend class Location;
+  friend class Model;
   Model& model_;
   uint32_t id_;
   Location& home_;
-  std::list<ItineraryEntry> itinerary_;
+  std::pmr::list<ItineraryEntry> itinerary_;
   InfectionCategory infection_state_;
-  time_pt infected_date_;
-  time_duration incubation_time_;
-  time_duration disease_time_;
+  time_pt state_entered_;
+  DiseaseDurations durations_;
+  double infectiousness_ = 1.0;
+  double susceptibility_ = 1.0;
+  double exposure_mark_ = 0.0;
   const ItineraryEntry* active_itinerary_entry_;
   Location* current_location;
-  std::function<void()> leave_callback_;
+  uint32_t location_slot_ = 0;
+  std::pmr::list<Person*>::iterator location_it_;
+  void setInfectionState(InfectionCategory new_state);
+  void trace(TraceEventKind kind, const Location& location);
   void moveToLocation(Location& location);
   void beginItineraryEntry(ItineraryEntry* entry);
   void endItineraryEntry(ItineraryEntry* entry);
@@ -126,49 +202,116 @@ class Model {
   Location& createLocation(double beta, std::string name = "");
   Person& createPerson(Location& home, time_duration incubation_time,
                        time_duration disease_time);
+  Person& createPerson(Location& home, const DiseaseDurations& durations);
   void simulate(time_duration simulation_duration);
+  void simulateFixedStep(time_duration simulation_duration,
+                         time_duration time_step);
+  bool fixedStepRunning() const;
+  void setTransmissionModel(TransmissionModel transmission_model);
+  TransmissionModel transmissionModel() const;
   void setStartDate(int year, int month, int day);
+  void saveScenario(const std::string& path);
+  void loadScenario(const std::string& path);
+  void mapPersonStorage(const std::string& path, size_t capacity);
+  MappedStorage& personStorage();
+  std::pmr::memory_resource& occupancyPool();
+  void saveCheckpoint(const std::string& path);
+  void loadCheckpoint(const std::string& path);
   time_pt currentTime();
   Person& getPerson(uint32_t i);
+  Location& getLocation(uint32_t i);
+  size_t numPersons() const;
+  size_t numLocations() const;
   SeirReport getReport();
-  SeirTimeline getDailyReports();
-  std::mt19937& randomGenerator();
-  void addToSchedule(time_pt scheduled_time, std::function<void()> callback);
+  const SeirTimeline& getDailyReports() const;
+  ReportSpan dailyReports() const;
+  void setKeepDailyReports(bool keep_daily_reports);
+  void addReportSink(std::shared_ptr<ReportSink> sink);
+  void flushReports();
+  void setLocationRecorder(std::shared_ptr<LocationRecorder> recorder);
+  bool recordingLocations() const;
+  void locationChanged(Location& location);
+  void setEventTrace(std::shared_ptr<EventTrace> event_trace);
+  EventTrace* eventTrace() const;
+  void setTransmissionLog(std::shared_ptr<TransmissionLog> transmission_log);
+  TransmissionLog* transmissionLog() const;
+  RandomGenerator& randomGenerator();
+  RandomBuffer& randomBuffer();
+  void seed(uint64_t seed_value);
+  void setLogger(std::shared_ptr<spdlog::logger> logger);
+  spdlog::logger* logger() const;
+  ModelStats stats() const;
+  void resetStats();
+  uint64_t eventsDispatched() const;
+  void setHardwareCounters(std::shared_ptr<HardwareCounters> counters);
+  HardwareCounters* hardwareCounters() const;
+  void setStatsPage(std::shared_ptr<StatsPage> stats_page);
+  StatsPage* statsPage() const;
+  StatsCounters& statsCounters();
+  MemoryReport memoryReport() const;
+  static MemoryReport estimateMemory(const ScenarioCounts& counts);
+  void addToSchedule(time_pt scheduled_time, ScheduledEvent event,
+                     Person* person = nullptr,
+                     ItineraryEntry* itinerary_entry = nullptr);
 
  private:
+  MappedStorage person_storage_;
+  std::pmr::unsynchronized_pool_resource occupancy_pool_;
   std::list<Location> locations_;
-  std::list<Person> persons_;
+  std::pmr::list<Person> persons_;
+  std::vector<Location*> location_index_;
+  std::vector<Person*> person_index_;
   bool simulation_running_ = false;
+  bool fixed_step_running_ = false;
+  TransmissionModel transmission_model_ = TransmissionModel::Binomial;
   std::shared_ptr<spdlog::logger> logger_;
   time_pt current_sim_time_;
   SeirReport latest_report_;
   SeirTimeline daily_reports_;
+  bool keep_daily_reports_ = true;
+  std::vector<std::shared_ptr<ReportSink>> report_sinks_;
+  std::shared_ptr<LocationRecorder> location_recorder_;
+  std::vector<Location*> changed_locations_;
+  std::shared_ptr<EventTrace> event_trace_;
+  std::shared_ptr<TransmissionLog> transmission_log_;
+  StatsCounters stats_counters_;
+  std::shared_ptr<HardwareCounters> hardware_counters_;
+  std::shared_ptr<StatsPage> stats_page_;
+  uint64_t events_dispatched_ = 0;
+  void publishStats(bool running);
   time_duration report_interval_;
   void collectSeir();
   void stopSimulation();
-  std::string getCurrentTimeString();
-  std::mt19937 random_generator_;
+  void prepareSchedule(time_pt stop_sim_at);
+  RandomGenerator random_generator_;
+  RandomBuffer random_buffer_;
   uint32_t last_id_ = 0;
   uint32_t getNextId();
 
   struct ScheduleEntry {
-    ScheduleEntry(time_pt t, std::function<void()> cb)
-        : scheduled_time(t), callback(cb) {};
-    ScheduleEntry(ScheduleEntry&& other)
-        : scheduled_time(std::move(other.scheduled_time))
-        , callback(std::move(other.callback)) {};
     time_pt scheduled_time;
-    std::function<void()> callback;
-    bool operator<(const ScheduleEntry& rhs) {
+    ScheduledEvent event;
+    Person* person;
+    ItineraryEntry* itinerary_entry;
+    bool operator<(const ScheduleEntry& rhs) const {
       return scheduled_time < rhs.scheduled_time;
     }
-    ScheduleEntry& operator= (ScheduleEntry&& other) {
-         scheduled_time = std::move(other.scheduled_time);
-         callback = std::move(other.callback);
-         return *this;
-    }
   };
-  std::deque<ScheduleEntry> schedule_;
+  void dispatch(const ScheduleEntry& schedule_entry);
+  std::vector<ScheduleEntry> schedule_;
+  size_t schedule_head_ = 0;
+
+  // Sets a running flag until the end of the scope, also when a run throws.
+  class RunningFlag {
+   public:
+    explicit RunningFlag(bool& flag) : flag_(flag) { flag_ = true; }
+    RunningFlag(const RunningFlag&) = delete;
+    RunningFlag& operator=(const RunningFlag&) = delete;
+    ~RunningFlag() { flag_ = false; }
+
+   private:
+    bool& flag_;
+  };
 };
 
 }  // namespace epideux
\ No newline at end of file
@@ -0,0 +1,155 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// C interface to the simulation engine.
+//
+// The model is an opaque handle, scenarios are built in bulk from arrays
+// owned by the caller, and results are written into buffers owned by the
+// caller. No C++ types cross the interface, so the library can be used from
+// any language with a C foreign function interface.
+//
+// Functions report failure through their status. The message of the last
+// failure on a model is available from epideux_last_error().
+//
+// Times are in seconds. Itinerary times are relative to the current
+// simulation time. An infinite disease duration never passes; the other times
+// must be finite and within the range of the clock. A batch with a bad row
+// changes nothing.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#if defined(EPIDEUX_C_BUILD)
+#define EPIDEUX_C_API __declspec(dllexport)
+#else
+#define EPIDEUX_C_API __declspec(dllimport)
+#endif
+#else
+#define EPIDEUX_C_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Incremented when the interface changes incompatibly.
+#define EPIDEUX_C_ABI_VERSION 1
+
+typedef struct epideux_model epideux_model;
+
+typedef enum {
+  EPIDEUX_OK = 0,
+  EPIDEUX_ERROR_INVALID_ARGUMENT = 1,
+  EPIDEUX_ERROR_OUT_OF_RANGE = 2,
+  EPIDEUX_ERROR_BUFFER_TOO_SMALL = 3,
+  EPIDEUX_ERROR_RUNTIME = 4
+} epideux_status;
+
+typedef enum {
+  EPIDEUX_TRANSMISSION_BINOMIAL = 0,
+  EPIDEUX_TRANSMISSION_EXPOSURE_ACCUMULATION = 1
+} epideux_transmission_model;
+
+EPIDEUX_C_API uint32_t epideux_abi_version(void);
+
+// The disease model compiled into the engine.
+EPIDEUX_C_API uint32_t epideux_num_states(void);
+EPIDEUX_C_API uint32_t epideux_num_durations(void);
+EPIDEUX_C_API const char* epideux_state_name(uint32_t state);
+
+// Returns NULL if the model could not be created.
+EPIDEUX_C_API epideux_model* epideux_model_create(void);
+EPIDEUX_C_API void epideux_model_destroy(epideux_model* model);
+EPIDEUX_C_API const char* epideux_last_error(const epideux_model* model);
+
+EPIDEUX_C_API epideux_status epideux_set_start_date(epideux_model* model,
+                                                    int year, int month,
+                                                    int day);
+EPIDEUX_C_API epideux_status epideux_seed(epideux_model* model,
+                                          uint64_t seed_value);
+EPIDEUX_C_API epideux_status epideux_set_transmission_model(
+    epideux_model* model, epideux_transmission_model transmission_model);
+
+// Create count locations with beta in infections/day. The ids of the new
+// locations are consecutive from *first_id.
+EPIDEUX_C_API epideux_status epideux_add_locations(epideux_model* model,
+                                                   size_t count,
+                                                   const double* beta,
+                                                   uint32_t* first_id);
+
+// Create count persons. The durations hold epideux_num_durations() values
+// per person. The ids of the new persons are consecutive from *first_id.
+EPIDEUX_C_API epideux_status epideux_add_persons(epideux_model* model,
+                                                 size_t count,
+                                                 const uint32_t* home,
+                                                 const double* durations,
+                                                 uint32_t* first_id);
+
+EPIDEUX_C_API epideux_status epideux_add_itinerary(
+    epideux_model* model, size_t count, const uint32_t* person,
+    const uint32_t* location, const double* start, const double* end);
+
+EPIDEUX_C_API epideux_status epideux_infect(epideux_model* model,
+                                            size_t count,
+                                            const uint32_t* person);
+
+EPIDEUX_C_API epideux_status epideux_simulate(epideux_model* model,
+                                              double duration);
+EPIDEUX_C_API epideux_status epideux_simulate_fixed_step(epideux_model* model,
+                                                         double duration,
+                                                         double time_step);
+
+EPIDEUX_C_API epideux_status epideux_load_scenario(epideux_model* model,
+                                                   const char* path);
+EPIDEUX_C_API epideux_status epideux_save_scenario(epideux_model* model,
+                                                   const char* path);
+EPIDEUX_C_API epideux_status epideux_save_checkpoint(epideux_model* model,
+                                                     const char* path);
+EPIDEUX_C_API epideux_status epideux_load_checkpoint(epideux_model* model,
+                                                     const char* path);
+
+EPIDEUX_C_API size_t epideux_num_persons(const epideux_model* model);
+EPIDEUX_C_API size_t epideux_num_locations(const epideux_model* model);
+EPIDEUX_C_API size_t epideux_num_reports(const epideux_model* model);
+
+// The current simulation time in seconds since the epoch.
+EPIDEUX_C_API double epideux_current_time(const epideux_model* model);
+
+// Write the latest report, epideux_num_states() counts, into out.
+EPIDEUX_C_API epideux_status epideux_get_report(epideux_model* model,
+                                                uint32_t* out);
+
+// Write the reports kept by the model, epideux_num_states() counts per
+// report, into out, which has room for capacity reports.
+EPIDEUX_C_API epideux_status epideux_get_reports(epideux_model* model,
+                                                 uint32_t* out,
+                                                 size_t capacity);
+
+// Write the state index and the current location of every person, in id
+// order, into out, which has room for capacity persons.
+EPIDEUX_C_API epideux_status epideux_get_person_states(epideux_model* model,
+                                                       uint8_t* out,
+                                                       size_t capacity);
+EPIDEUX_C_API epideux_status epideux_get_person_locations(
+    epideux_model* model, uint32_t* out, size_t capacity);
+
+#ifdef __cplusplus
+}
+#endif
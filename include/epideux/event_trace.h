@@ -0,0 +1,103 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace epideux {
+
+enum class TraceEventKind : uint8_t {
+  Move,
+  BeginItineraryEntry,
+  EndItineraryEntry,
+  Infection,
+  StateChange
+};
+
+// A fixed-size trace record. The time is in nanoseconds since the epoch, and
+// state is the infection state after the event as an index into the disease
+// model's compartments.
+struct TraceRecord {
+  int64_t time;
+  uint32_t person;
+  uint32_t location;
+  TraceEventKind kind;
+  uint8_t state;
+  uint8_t reserved[6];
+};
+
+static_assert(sizeof(TraceRecord) == 24, "Trace records must be 24 bytes");
+
+// The trace file starts with this header, followed by the records. The number
+// of states identifies the disease model the states in the records refer to.
+struct TraceFileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t record_size;
+  uint32_t num_states;
+  uint32_t reserved;
+};
+
+constexpr char kTraceMagic[8] = {'E', 'P', 'I', 'D', 'E', 'U', 'X', 'T'};
+constexpr uint32_t kTraceVersion = 2;
+
+class EventTrace {
+ public:
+  explicit EventTrace(const std::string& path, size_t buffer_records = 1 << 16);
+  EventTrace(const EventTrace&) = delete;
+  EventTrace& operator=(const EventTrace&) = delete;
+  ~EventTrace();
+  void record(int64_t time, TraceEventKind kind, uint32_t person,
+              uint32_t location, uint8_t state);
+  void flush();
+  uint64_t numRecords() const;
+
+ private:
+  typedef std::vector<TraceRecord> Buffer;
+  struct ThreadBuffer {
+    std::unique_ptr<Buffer> buffer;
+  };
+  uint64_t id_;
+  std::string path_;
+  FILE* file_;
+  size_t buffer_records_;
+  uint64_t num_records_ = 0;
+  bool write_failed_ = false;
+  mutable std::mutex mutex_;
+  std::condition_variable work_available_;
+  std::condition_variable work_done_;
+  std::deque<std::unique_ptr<Buffer>> full_buffers_;
+  std::vector<std::unique_ptr<Buffer>> free_buffers_;
+  std::vector<std::shared_ptr<ThreadBuffer>> thread_buffers_;
+  bool writing_ = false;
+  bool stop_ = false;
+  std::thread writer_;
+  ThreadBuffer& threadBuffer();
+  void handOff(ThreadBuffer& thread_buffer);
+  void writerLoop();
+};
+
+}  // namespace epideux
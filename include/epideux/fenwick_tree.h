@@ -0,0 +1,48 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <vector>
+
+namespace epideux {
+
+class FenwickTree {
+ public:
+  size_t size() const;
+  void reserve(size_t n);
+  void pushBack(double weight);
+  void set(size_t i, double weight);
+  double get(size_t i) const;
+  double total() const;
+  size_t find(double u) const;
+  size_t capacityBytes() const;
+  void save(std::ostream& out) const;
+  void load(std::istream& in);
+
+ private:
+  std::vector<double> values_;
+  std::vector<double> tree_ = {0.0};
+  size_t capacity_ = 0;
+  double total_ = 0.0;
+  void add(size_t i, double delta);
+  void rebuild(size_t new_capacity);
+};
+
+}  // namespace epideux
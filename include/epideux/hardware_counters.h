@@ -0,0 +1,98 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "epideux/model_stats.h"
+
+namespace epideux {
+
+enum class HardwareEvent : uint8_t {
+  Cycles,
+  Instructions,
+  L1dReadMisses,
+  LlcMisses,
+  BranchMisses,
+  NumEvents
+};
+
+constexpr size_t kNumHardwareEvents =
+    static_cast<size_t>(HardwareEvent::NumEvents);
+
+typedef std::array<uint64_t, kNumHardwareEvents> HardwareCounts;
+
+// Hardware performance counters of the calling thread, read through Linux's
+// perf_event_open and attributed to the phases of a simulation run. Create
+// the counters on the thread that runs the simulation.
+class HardwareCounters {
+ public:
+  HardwareCounters();
+  HardwareCounters(const HardwareCounters&) = delete;
+  HardwareCounters& operator=(const HardwareCounters&) = delete;
+  ~HardwareCounters();
+  bool available() const;
+  bool available(HardwareEvent event) const;
+  const std::string& error() const;
+  bool read(HardwareCounts& counts) const;
+  void add(StatsPhase phase, const HardwareCounts& begin,
+           const HardwareCounts& end);
+  const HardwareCounts& phase(StatsPhase phase) const;
+  void reset();
+  static const char* eventName(HardwareEvent event);
+
+ private:
+  int group_fd_ = -1;
+  int fds_[kNumHardwareEvents];
+  // The position of each event in a group read, or -1 if it is not counted.
+  int positions_[kNumHardwareEvents];
+  int num_open_ = 0;
+  std::string error_;
+  std::array<HardwareCounts, kNumStatsPhases> phases_ = {};
+};
+
+// Adds the counts until the end of the scope to a phase. Does nothing
+// without counters.
+class HardwarePhaseScope {
+ public:
+  HardwarePhaseScope(HardwareCounters* counters, StatsPhase phase)
+      : counters_(counters), phase_(phase) {
+    if (counters_ && !counters_->read(begin_)) {
+      counters_ = nullptr;
+    }
+  }
+  HardwarePhaseScope(const HardwarePhaseScope&) = delete;
+  HardwarePhaseScope& operator=(const HardwarePhaseScope&) = delete;
+  ~HardwarePhaseScope() {
+    HardwareCounts end;
+    if (counters_ && counters_->read(end)) {
+      counters_->add(phase_, begin_, end);
+    }
+  }
+
+ private:
+  HardwareCounters* counters_;
+  StatsPhase phase_;
+  HardwareCounts begin_;
+};
+
+}  // namespace epideux
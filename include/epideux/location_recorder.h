@@ -0,0 +1,48 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "epideux/epideux.h"
+
+namespace epideux {
+
+typedef std::vector<std::pair<time_pt, SeirReport>> LocationSeries;
+
+class LocationRecorder {
+ public:
+  explicit LocationRecorder(size_t chunk_size = 1 << 20);
+  void record(time_pt tick_time, std::vector<Location*>& changed_locations);
+  LocationSeries series(uint32_t location_id) const;
+  size_t numTicks() const;
+  size_t encodedBytes() const;
+
+ private:
+  size_t chunk_size_;
+  std::vector<std::vector<uint8_t>> chunks_;
+  std::vector<time_pt> tick_times_;
+  std::vector<uint32_t> last_counts_;
+  std::vector<std::pair<uint32_t, SeirReport>> changed_;
+  void putVarint(uint64_t value);
+};
+
+}  // namespace epideux
@@ -0,0 +1,85 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <chrono>
+#include <ctime>
+
+#include "spdlog/spdlog.h"
+
+// The engine logs through these macros. Messages above SPDLOG_ACTIVE_LEVEL,
+// set with the EPIDEUX_LOG_LEVEL CMake option, are compiled out. The others
+// only evaluate and format their arguments when the logger is set and its
+// level lets the message through.
+#define EPIDEUX_LOG(logger_ptr, level, ...)                                \
+  do {                                                                     \
+    spdlog::logger* epideux_logger_ = (logger_ptr);                        \
+    if (epideux_logger_ && epideux_logger_->should_log(level)) {           \
+      epideux_logger_->log(                                                \
+          spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}, level,  \
+          __VA_ARGS__);                                                    \
+    }                                                                      \
+  } while (0)
+
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_TRACE
+#define EPIDEUX_LOG_TRACE(logger, ...) \
+  EPIDEUX_LOG(logger, spdlog::level::trace, __VA_ARGS__)
+#else
+#define EPIDEUX_LOG_TRACE(logger, ...) (void)0
+#endif
+
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_DEBUG
+#define EPIDEUX_LOG_DEBUG(logger, ...) \
+  EPIDEUX_LOG(logger, spdlog::level::debug, __VA_ARGS__)
+#else
+#define EPIDEUX_LOG_DEBUG(logger, ...) (void)0
+#endif
+
+#if SPDLOG_ACTIVE_LEVEL <= SPDLOG_LEVEL_INFO
+#define EPIDEUX_LOG_INFO(logger, ...) \
+  EPIDEUX_LOG(logger, spdlog::level::info, __VA_ARGS__)
+#else
+#define EPIDEUX_LOG_INFO(logger, ...) (void)0
+#endif
+
+namespace epideux {
+
+// A simulation time, formatted as the local date and time when logged.
+struct LogTime {
+  std::chrono::system_clock::time_point time;
+};
+
+}  // namespace epideux
+
+namespace fmt {
+
+template <>
+struct formatter<epideux::LogTime> : formatter<string_view> {
+  template <typename FormatContext>
+  auto format(const epideux::LogTime& log_time, FormatContext& ctx) {
+    std::time_t t = std::chrono::system_clock::to_time_t(log_time.time);
+    std::tm tm;
+    localtime_r(&t, &tm);
+    char t_str[100];
+    size_t length = std::strftime(t_str, sizeof(t_str), "%c", &tm);
+    return formatter<string_view>::format(string_view(t_str, length), ctx);
+  }
+};
+
+}  // namespace fmt
@@ -0,0 +1,62 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace epideux {
+
+// Memory for the person and itinerary tables. It allocates from the heap
+// until it is mapped onto a file, after which the tables live in the file and
+// the operating system pages them in and out as needed.
+class MappedStorage : public std::pmr::memory_resource {
+ public:
+  enum class Advice { Normal, Random, Sequential, WillNeed, DontNeed };
+  MappedStorage() = default;
+  MappedStorage(const MappedStorage&) = delete;
+  MappedStorage& operator=(const MappedStorage&) = delete;
+  ~MappedStorage() override;
+  void map(const std::string& path, size_t capacity);
+  bool mapped() const;
+  size_t used() const;
+  size_t capacity() const;
+  void advise(Advice advice);
+  void reserve(size_t bytes);
+
+ private:
+  void* do_allocate(size_t bytes, size_t alignment) override;
+  void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+  bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override;
+  char* base_ = nullptr;
+  size_t capacity_ = 0;
+  size_t used_ = 0;
+  size_t file_size_ = 0;
+  int fd_ = -1;
+  // Blocks reserved in memory, handed out back to back like the file.
+  std::vector<std::pair<char*, size_t>> blocks_;
+  size_t block_used_ = 0;
+  bool inBlocks(const char* p) const;
+};
+
+}  // namespace epideux
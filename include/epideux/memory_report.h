@@ -0,0 +1,67 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace epideux {
+
+// The bytes held by the parts of a model, including the bookkeeping of the
+// allocator and the containers. With mapped person storage the persons and
+// itineraries live in the file and are paged in and out by the OS.
+struct MemoryReport {
+  size_t persons = 0;         // Person objects and the index by id.
+  size_t itinerary = 0;       // The itinerary entries of all persons.
+  size_t locations = 0;       // Location objects and the index by id.
+  size_t location_names = 0;  // Names too long for the string itself.
+  size_t occupancy = 0;       // The lists of persons at each location.
+  size_t sampling = 0;        // The weight trees and slots at each location.
+  size_t schedule = 0;        // Pending events.
+  size_t reports = 0;         // The kept daily reports.
+  bool persons_mapped = false;
+  size_t total() const {
+    return persons + itinerary + locations + location_names + occupancy +
+           sampling + schedule + reports;
+  }
+};
+
+// The size of a scenario, for estimating the memory before building it.
+struct ScenarioCounts {
+  size_t num_persons = 0;
+  size_t num_locations = 0;
+  size_t num_itinerary_entries = 0;
+  size_t names_size = 0;  // The summed length of the location names.
+  size_t num_reports = 0;  // E.g., the number of days to simulate.
+};
+
+ScenarioCounts countScenario(const std::string& path, size_t num_reports);
+
+// The size of a std::list node holding a T, i.e., the value and two links.
+template <typename T>
+constexpr size_t listNodeSize() {
+  struct Node {
+    void* next;
+    void* prev;
+    alignas(T) unsigned char value[sizeof(T)];
+  };
+  return sizeof(Node);
+}
+
+}  // namespace epideux
@@ -0,0 +1,115 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace epideux {
+
+// The phases of a simulation run that are timed.
+enum class StatsPhase : uint8_t {
+  Schedule,        // Generating and sorting the schedule.
+  Movement,        // Itinerary events, including the infections they evaluate.
+  Report,          // Collecting the reports, including the infections.
+  Transmission,    // The fixed-step sweep over all locations.
+  LocationUpdate,  // Evaluating the infections at a location, also counted in
+                   // the phase it happens in.
+  NumPhases
+};
+
+// The kinds of ScheduledEvent, which is checked where it is declared.
+constexpr size_t kNumScheduledEvents = 4;
+constexpr size_t kNumStatsPhases = static_cast<size_t>(StatsPhase::NumPhases);
+
+// A snapshot of the performance counters of a model.
+struct ModelStats {
+  uint64_t events[kNumScheduledEvents] = {};
+  uint64_t update_infections_calls = 0;
+  uint64_t occupants_visited = 0;
+  uint64_t binomial_draws = 0;
+  uint64_t infections = 0;
+  uint64_t peak_schedule_size = 0;
+  double phase_seconds[kNumStatsPhases] = {};
+};
+
+// The live counters. Only the simulation thread writes them, so they are
+// updated with plain loads and stores, while other threads can still read
+// them safely during a run.
+struct StatsCounters {
+  std::atomic<uint64_t> events[kNumScheduledEvents] = {};
+  std::atomic<uint64_t> update_infections_calls{0};
+  std::atomic<uint64_t> occupants_visited{0};
+  std::atomic<uint64_t> binomial_draws{0};
+  std::atomic<uint64_t> infections{0};
+  std::atomic<uint64_t> peak_schedule_size{0};
+  std::atomic<uint64_t> phase_nanoseconds[kNumStatsPhases] = {};
+
+  static void add(std::atomic<uint64_t>& counter, uint64_t n) {
+    counter.store(counter.load(std::memory_order_relaxed) + n,
+                  std::memory_order_relaxed);
+  }
+  static void max(std::atomic<uint64_t>& counter, uint64_t n) {
+    if (n > counter.load(std::memory_order_relaxed)) {
+      counter.store(n, std::memory_order_relaxed);
+    }
+  }
+  ModelStats snapshot() const;
+  void reset();
+};
+
+// Adds the time until the end of the scope to a phase.
+class StatsPhaseTimer {
+ public:
+  StatsPhaseTimer(StatsCounters& counters, StatsPhase phase)
+      : counter_(counters.phase_nanoseconds[static_cast<size_t>(phase)]),
+        start_(std::chrono::steady_clock::now()) {}
+  StatsPhaseTimer(const StatsPhaseTimer&) = delete;
+  StatsPhaseTimer& operator=(const StatsPhaseTimer&) = delete;
+  ~StatsPhaseTimer() {
+    auto elapsed = std::chrono::steady_clock::now() - start_;
+    StatsCounters::add(
+        counter_,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+  }
+
+ private:
+  std::atomic<uint64_t>& counter_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+// The counting is compiled in with the EPIDEUX_ENABLE_STATS CMake option.
+// Otherwise the macros expand to nothing and the counters stay zero.
+#if defined(EPIDEUX_ENABLE_STATS)
+#define EPIDEUX_STATS_ADD(model, counter, n) \
+  ::epideux::StatsCounters::add((model).statsCounters().counter, (n))
+#define EPIDEUX_STATS_MAX(model, counter, n) \
+  ::epideux::StatsCounters::max((model).statsCounters().counter, (n))
+#define EPIDEUX_STATS_PHASE(model, phase)        \
+  ::epideux::StatsPhaseTimer stats_phase_timer( \
+      (model).statsCounters(), ::epideux::StatsPhase::phase)
+#else
+#define EPIDEUX_STATS_ADD(model, counter, n) ((void)0)
+#define EPIDEUX_STATS_MAX(model, counter, n) ((void)0)
+#define EPIDEUX_STATS_PHASE(model, phase) ((void)0)
+#endif
+
+}  // namespace epideux
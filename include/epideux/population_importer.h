@@ -0,0 +1,61 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "epideux/epideux.h"
+
+namespace epideux {
+
+struct ImportStats {
+  uint64_t bytes = 0;
+  uint64_t rows = 0;
+  double seconds = 0.0;
+  double rowsPerSecond() const;
+  double megabytesPerSecond() const;
+};
+
+class PopulationImporter {
+ public:
+  explicit PopulationImporter(Model& simulation_model, char delimiter = ',');
+  void setDefaultBeta(double beta);
+  void setDefaultDurations(time_duration incubation_time,
+                           time_duration disease_time);
+  ImportStats importLocations(const std::string& path);
+  ImportStats importPersons(const std::string& path);
+  ImportStats importVisits(const std::string& path);
+  void finish();
+
+ private:
+  Model& model_;
+  char delimiter_;
+  time_pt origin_;
+  double default_beta_ = 0.0;
+  time_duration default_incubation_time_;
+  time_duration default_disease_time_;
+  std::unordered_map<uint64_t, Location*> locations_;
+  std::unordered_map<uint64_t, Person*> persons_;
+  Location& location(uint64_t id);
+  template <typename RowHandler>
+  ImportStats readRows(const std::string& path, RowHandler handle_row);
+};
+
+}  // namespace epideux
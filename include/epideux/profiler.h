@@ -0,0 +1,81 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace epideux {
+
+// A zone of code between two timestamps, in nanoseconds since the profiler
+// started.
+struct ProfileRecord {
+  const char* name;
+  uint64_t begin;
+  uint64_t end;
+};
+
+// A process-wide profiler of zones. Each thread records into its own
+// buffer, so recording takes no locks.
+class Profiler {
+ public:
+  static void start();
+  static void stop();
+  static bool running();
+  static uint64_t now();
+  static void record(const char* name, uint64_t begin, uint64_t end);
+  static size_t numRecords();
+  static void clear();
+  static void writeChromeTrace(const std::string& path);
+};
+
+// Records the time from construction to the end of the scope, while the
+// profiler runs. The name must outlive the profiler, e.g., a literal.
+class ProfileZone {
+ public:
+  explicit ProfileZone(const char* name)
+      : name_(name), active_(Profiler::running()),
+        begin_(active_ ? Profiler::now() : 0) {}
+  ProfileZone(const ProfileZone&) = delete;
+  ProfileZone& operator=(const ProfileZone&) = delete;
+  ~ProfileZone() {
+    if (active_) {
+      Profiler::record(name_, begin_, Profiler::now());
+    }
+  }
+
+ private:
+  const char* name_;
+  bool active_;
+  uint64_t begin_;
+};
+
+// The zones in the engine are compiled in with the EPIDEUX_ENABLE_PROFILER
+// CMake option. Otherwise the macro expands to nothing.
+#if defined(EPIDEUX_ENABLE_PROFILER)
+#define EPIDEUX_PROFILE_CONCAT_(a, b) a##b
+#define EPIDEUX_PROFILE_CONCAT(a, b) EPIDEUX_PROFILE_CONCAT_(a, b)
+#define EPIDEUX_PROFILE_ZONE(name) \
+  ::epideux::ProfileZone EPIDEUX_PROFILE_CONCAT(profile_zone_, __LINE__)(name)
+#else
+#define EPIDEUX_PROFILE_ZONE(name) ((void)0)
+#endif
+
+}  // namespace epideux
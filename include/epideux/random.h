@@ -0,0 +1,173 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace epideux {
+
+// xoshiro256++ by Blackman and Vigna. Fast, 256 bits of state and good
+// statistical quality.
+class Xoshiro256pp {
+ public:
+  typedef uint64_t result_type;
+  explicit Xoshiro256pp(uint64_t seed_value = 5489u);
+  void seed(uint64_t seed_value);
+  void jump();
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+  result_type operator()() {
+    uint64_t result = rotl(s_[0] + s_[3], 23) + s_[0];
+    uint64_t t = s_[1] << 17;
+    s_[2] ^= s_[0];
+    s_[3] ^= s_[1];
+    s_[1] ^= s_[2];
+    s_[0] ^= s_[3];
+    s_[2] ^= t;
+    s_[3] = rotl(s_[3], 45);
+    return result;
+  }
+  friend std::ostream& operator<<(std::ostream& os, const Xoshiro256pp& gen);
+  friend std::istream& operator>>(std::istream& is, Xoshiro256pp& gen);
+
+ private:
+  uint64_t s_[4];
+  static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+};
+
+// PCG-XSH-RR 64/32 by O'Neill. Small state and fast on 32 bit outputs.
+class Pcg32 {
+ public:
+  typedef uint32_t result_type;
+  explicit Pcg32(uint64_t seed_value = 5489u);
+  void seed(uint64_t seed_value);
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+  result_type operator()() {
+    uint64_t old_state = state_;
+    state_ = old_state * 6364136223846793005ULL + increment_;
+    uint32_t xorshifted = ((old_state >> 18u) ^ old_state) >> 27u;
+    uint32_t rot = old_state >> 59u;
+    return (xorshifted >> rot) | (xorshifted << ((~rot + 1u) & 31));
+  }
+  friend std::ostream& operator<<(std::ostream& os, const Pcg32& gen);
+  friend std::istream& operator>>(std::istream& is, Pcg32& gen);
+
+ private:
+  uint64_t state_;
+  uint64_t increment_;
+};
+
+// Four interleaved xoshiro256++ streams. The state is laid out lane by lane,
+// so the loop in fill() is vectorized by the compiler.
+class Xoshiro256ppX4 {
+ public:
+  explicit Xoshiro256ppX4(uint64_t seed_value = 5489u);
+  void seed(uint64_t seed_value);
+  void fill(uint64_t* out, size_t n);
+  friend std::ostream& operator<<(std::ostream& os, const Xoshiro256ppX4& gen);
+  friend std::istream& operator>>(std::istream& is, Xoshiro256ppX4& gen);
+
+ private:
+  static constexpr size_t kLanes = 4;
+  uint64_t s0_[kLanes], s1_[kLanes], s2_[kLanes], s3_[kLanes];
+};
+
+// The generators of the model are chosen at build time through the
+// EPIDEUX_RNG CMake option. BufferGenerator fills the RandomBuffer that the
+// engine draws from, and RandomGenerator is handed out for the randomness of
+// the scenario. For xoshiro256++ the buffer is filled from four interleaved
+// streams.
+#if defined(EPIDEUX_RNG_MT19937)
+typedef std::mt19937 RandomGenerator;
+typedef std::mt19937 BufferGenerator;
+#elif defined(EPIDEUX_RNG_PCG32)
+typedef Pcg32 RandomGenerator;
+typedef Pcg32 BufferGenerator;
+#else
+typedef Xoshiro256pp RandomGenerator;
+typedef Xoshiro256ppX4 BufferGenerator;
+#endif
+
+// Fill a buffer with 64 random bits per value from a generator of 32 or 64
+// bit values.
+template <typename Generator>
+void fillBits(Generator& gen, uint64_t* out, size_t n) {
+  constexpr uint64_t kMax = Generator::max();
+  static_assert((Generator::min() == 0) &&
+                    ((kMax == std::numeric_limits<uint32_t>::max()) ||
+                     (kMax == std::numeric_limits<uint64_t>::max())),
+                "The generator must produce full 32 or 64 bit values");
+  for (size_t i = 0; i < n; ++i) {
+    if (kMax == std::numeric_limits<uint32_t>::max()) {
+      uint64_t high = gen();
+      out[i] = (high << 32) | static_cast<uint32_t>(gen());
+    } else {
+      out[i] = gen();
+    }
+  }
+}
+
+inline void fillBits(Xoshiro256ppX4& gen, uint64_t* out, size_t n) {
+  gen.fill(out, n);
+}
+
+// A buffer of precomputed random bits for the hot loops.
+class RandomBuffer {
+ public:
+  typedef uint64_t result_type;
+  explicit RandomBuffer(uint64_t seed_value = 5489u, size_t size = 4096);
+  void seed(uint64_t seed_value);
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+  result_type operator()() {
+    if (position_ == bits_.size()) {
+      refill();
+    }
+    return bits_[position_++];
+  }
+  double uniform() { return ((*this)() >> 11) * 0x1.0p-53; }
+  uint32_t binomial(uint32_t n, double p);
+  friend std::ostream& operator<<(std::ostream& os, const RandomBuffer& buffer);
+  friend std::istream& operator>>(std::istream& is, RandomBuffer& buffer);
+
+ private:
+  BufferGenerator generator_;
+  std::vector<uint64_t> bits_;
+  size_t position_;
+  std::binomial_distribution<uint32_t> binomial_dist_;
+  void refill();
+};
+
+void fillUniform(Xoshiro256ppX4& gen, double* out, size_t n);
+void fillExponential(Xoshiro256ppX4& gen, double* out, size_t n, double rate);
+void fillBinomial(RandomBuffer& buffer, uint32_t* out, const uint32_t* n,
+                  const double* p, size_t count);
+
+}  // namespace epideux
@@ -0,0 +1,90 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "epideux/epideux.h"
+
+namespace epideux {
+
+// Receives the reports as the model produces them.
+class ReportSink {
+ public:
+  virtual ~ReportSink() = default;
+  virtual void write(time_pt report_time, const SeirReport& report) = 0;
+  virtual void flush() {}
+};
+
+// Writes one CSV row per report through a fixed-size buffer.
+class CsvReportSink : public ReportSink {
+ public:
+  explicit CsvReportSink(const std::string& path, size_t buffer_size = 1 << 16);
+  CsvReportSink(const CsvReportSink&) = delete;
+  CsvReportSink& operator=(const CsvReportSink&) = delete;
+  ~CsvReportSink() override;
+  void write(time_pt report_time, const SeirReport& report) override;
+  void flush() override;
+
+ private:
+  std::string path_;
+  FILE* file_;
+  std::vector<char> buffer_;
+  size_t used_ = 0;
+};
+
+// Writes the reports in blocks, column by column. See the constructor for the
+// file layout.
+class BinaryReportSink : public ReportSink {
+ public:
+  explicit BinaryReportSink(const std::string& path, size_t block_size = 4096);
+  BinaryReportSink(const BinaryReportSink&) = delete;
+  BinaryReportSink& operator=(const BinaryReportSink&) = delete;
+  ~BinaryReportSink() override;
+  void write(time_pt report_time, const SeirReport& report) override;
+  void flush() override;
+
+ private:
+  std::string path_;
+  FILE* file_;
+  size_t block_size_;
+  std::vector<int64_t> times_;
+  std::vector<uint32_t> counts_;
+};
+
+// Keeps the latest reports in a bounded buffer.
+class RingBufferReportSink : public ReportSink {
+ public:
+  explicit RingBufferReportSink(size_t capacity);
+  void write(time_pt report_time, const SeirReport& report) override;
+  size_t size() const;
+  size_t capacity() const;
+  const SeirReport& report(size_t i) const;
+  time_pt reportTime(size_t i) const;
+
+ private:
+  std::vector<SeirReport> reports_;
+  std::vector<time_pt> times_;
+  size_t next_ = 0;
+  size_t size_ = 0;
+};
+
+}  // namespace epideux
@@ -0,0 +1,95 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace epideux {
+
+// The binary scenario format. All integers are little-endian, times are
+// nanoseconds since the epoch and durations are nanoseconds. The file starts
+// with a ScenarioHeader followed by the flat arrays at the offsets given in
+// the header. The itinerary entries are sorted by person and start time, and
+// each person refers to a contiguous range of them. The persons' states are
+// indices into the states of the disease model the file was written with.
+constexpr char kScenarioMagic[8] = {'E', 'P', 'I', 'D', 'E', 'U', 'X', 'S'};
+constexpr uint32_t kScenarioVersion = 2;
+constexpr size_t kScenarioMaxDurations = 4;
+
+struct ScenarioHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t num_durations;
+  uint32_t num_states;
+  uint32_t reserved;
+  int64_t start_time;
+  uint64_t num_locations;
+  uint64_t num_persons;
+  uint64_t num_itinerary_entries;
+  uint64_t names_size;
+  uint64_t locations_offset;
+  uint64_t persons_offset;
+  uint64_t itinerary_offset;
+  uint64_t names_offset;
+};
+
+struct ScenarioLocation {
+  double beta;
+  uint64_t name_offset;
+  uint32_t name_length;
+  uint32_t reserved;
+};
+
+struct ScenarioPerson {
+  uint32_t home;
+  uint32_t state;
+  uint64_t itinerary_begin;
+  uint64_t itinerary_count;
+  int64_t state_entered;
+  int64_t durations[kScenarioMaxDurations];
+};
+
+struct ScenarioItineraryEntry {
+  uint32_t location;
+  uint32_t reserved;
+  int64_t start;
+  int64_t end;
+};
+
+class ScenarioFile {
+ public:
+  explicit ScenarioFile(const std::string& path);
+  ScenarioFile(const ScenarioFile&) = delete;
+  ScenarioFile& operator=(const ScenarioFile&) = delete;
+  ~ScenarioFile();
+  const ScenarioHeader& header() const;
+  const ScenarioLocation* locations() const;
+  const ScenarioPerson* persons() const;
+  const ScenarioItineraryEntry* itineraryEntries() const;
+  const char* names() const;
+
+ private:
+  const char* data_;
+  size_t size_;
+  template <typename T>
+  const T* array(uint64_t offset, uint64_t count) const;
+};
+
+}  // namespace epideux
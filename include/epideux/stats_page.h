@@ -0,0 +1,98 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace epideux {
+
+constexpr char kStatsPageMagic[8] = {'E', 'P', 'I', 'D', 'E', 'U', 'X', 'M'};
+constexpr uint32_t kStatsPageVersion = 1;
+constexpr size_t kStatsPageMaxStates = 8;
+
+// The statistics of a running model. Times are nanoseconds since the epoch.
+struct StatsPageData {
+  int64_t sim_time;
+  int64_t wall_time;
+  uint64_t events;
+  double events_per_second;
+  uint64_t schedule_depth;
+  uint64_t num_persons;
+  uint64_t resident_bytes;
+  uint32_t running;
+  uint32_t num_states;
+  uint32_t report[kStatsPageMaxStates];
+};
+
+constexpr size_t kStatsPageWords = sizeof(StatsPageData) / sizeof(uint64_t);
+static_assert(sizeof(StatsPageData) % sizeof(uint64_t) == 0,
+              "The page is copied in words");
+
+// The shared memory segment. The data is guarded by a sequence lock: the
+// sequence is odd while the model writes, so readers retry instead of making
+// the writer wait.
+struct StatsPageLayout {
+  char magic[8];
+  uint32_t version;
+  uint32_t size;
+  std::atomic<uint64_t> sequence;
+  std::atomic<uint64_t> words[kStatsPageWords];
+};
+
+// Publishes the statistics of a model in a POSIX shared memory segment, so
+// other processes can watch a run, e.g., with epideux_monitor.
+class StatsPage {
+ public:
+  explicit StatsPage(const std::string& name,
+                     std::chrono::milliseconds interval =
+                         std::chrono::milliseconds(100));
+  StatsPage(const StatsPage&) = delete;
+  StatsPage& operator=(const StatsPage&) = delete;
+  ~StatsPage();
+  const std::string& name() const;
+  bool due() const;
+  void publish(StatsPageData data);
+
+ private:
+  std::string name_;
+  std::chrono::steady_clock::duration interval_;
+  StatsPageLayout* page_ = nullptr;
+  std::chrono::steady_clock::time_point last_publish_;
+  uint64_t last_events_ = 0;
+  double events_per_second_ = 0.0;
+};
+
+// Reads the statistics published by a model in another process.
+class StatsPageReader {
+ public:
+  explicit StatsPageReader(const std::string& name);
+  StatsPageReader(const StatsPageReader&) = delete;
+  StatsPageReader& operator=(const StatsPageReader&) = delete;
+  ~StatsPageReader();
+  bool read(StatsPageData& data) const;
+
+ private:
+  const StatsPageLayout* page_ = nullptr;
+};
+
+}  // namespace epideux
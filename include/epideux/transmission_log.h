@@ -0,0 +1,59 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace epideux {
+
+// The infector of a transmission that could not be attributed.
+constexpr uint32_t kNoInfector = std::numeric_limits<uint32_t>::max();
+
+// A transmission event. The time is in nanoseconds since the epoch, and
+// num_infectious is the number of infectious occupants the infector was
+// sampled among. With exposure accumulation, these are the occupants present
+// when the victim's exposure was settled.
+struct TransmissionRecord {
+  int64_t time;
+  uint32_t victim;
+  uint32_t location;
+  uint32_t infector;
+  uint32_t num_infectious;
+};
+
+class TransmissionLog {
+ public:
+  explicit TransmissionLog(size_t chunk_records = 1 << 16);
+  void append(const TransmissionRecord& record);
+  size_t size() const;
+  const TransmissionRecord& operator[](size_t i) const;
+  void exportBinary(const std::string& path) const;
+  void exportEdgeList(const std::string& path) const;
+
+ private:
+  size_t chunk_records_;
+  size_t size_ = 0;
+  std::vector<std::unique_ptr<TransmissionRecord[]>> chunks_;
+};
+
+}  // namespace epideux
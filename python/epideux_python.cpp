@@ -0,0 +1,746 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+// CPython extension module driving the model from Python.
+//
+// Scenarios are built in bulk from objects supporting the buffer protocol,
+// e.g., NumPy arrays, and the results are handed back as read-only
+// memoryviews of the model's own memory. A model refuses to change the
+// memory while views of it exist, like a bytearray does, so release the views
+// (or copy them) before simulating further. While simulate() runs without the
+// interpreter lock, the model refuses to be used from other threads.
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "epideux/epideux.h"
+
+namespace {
+
+using namespace epideux;
+
+static_assert(sizeof(SeirReport) == DiseaseModel::num_states * sizeof(uint32_t),
+              "Reports must be packed counts");
+
+enum class ViewKind { Reports, PersonStates, NumKinds };
+
+struct PyModel {
+  PyObject_HEAD
+  Model* model;
+  std::vector<uint8_t>* person_states;
+  Py_ssize_t exports[static_cast<size_t>(ViewKind::NumKinds)];
+  bool running;
+};
+
+// The exporter behind the memoryviews handed out by a model.
+struct PyArrayView {
+  PyObject_HEAD
+  PyModel* owner;
+  ViewKind kind;
+  Py_ssize_t shape[2];
+  Py_ssize_t strides[2];
+};
+
+PyTypeObject PyModelType = {PyVarObject_HEAD_INIT(nullptr, 0)};
+PyTypeObject PyArrayViewType = {PyVarObject_HEAD_INIT(nullptr, 0)};
+
+///
+/// Translate the exception being handled into a Python exception.
+///
+void setPythonError() {
+  try {
+    throw;
+  } catch (const std::out_of_range& e) {
+    PyErr_SetString(PyExc_IndexError, e.what());
+  } catch (const std::invalid_argument& e) {
+    PyErr_SetString(PyExc_ValueError, e.what());
+  } catch (const std::exception& e) {
+    PyErr_SetString(PyExc_RuntimeError, e.what());
+  }
+}
+
+///
+/// Convert an item of type S to T, refusing values T cannot hold.
+///
+/// The integer targets are ids, so they take whole, non-negative numbers
+/// only. Floating point targets take anything but NaN.
+///
+template <typename S, typename T>
+bool convertItem(const char* item, T& out) {
+  S value;
+  std::memcpy(&value, item, sizeof(S));
+  if constexpr (std::is_integral_v<T>) {
+    static_assert(std::is_unsigned_v<T>, "Integer targets are ids");
+    if constexpr (std::is_floating_point_v<S>) {
+      double v = value;
+      if (!(v >= 0.0) ||
+          !(v <= static_cast<double>(std::numeric_limits<T>::max())) ||
+          (v != std::floor(v))) {
+        return false;
+      }
+    } else {
+      if constexpr (std::is_signed_v<S>) {
+        if (value < 0) {
+          return false;
+        }
+      }
+      if (static_cast<unsigned long long>(value) >
+          std::numeric_limits<T>::max()) {
+        return false;
+      }
+    }
+  } else if constexpr (std::is_floating_point_v<S>) {
+    if (std::isnan(value)) {
+      return false;
+    }
+  }
+  out = static_cast<T>(value);
+  return true;
+}
+
+///
+/// Copy a C contiguous buffer of any numeric type into a vector.
+///
+/// The buffer must have the given number of dimensions. The shape is returned
+/// in shape. All values are checked before any is used, see convertItem().
+///
+template <typename T>
+bool readBuffer(PyObject* obj, int ndim, std::vector<T>& out,
+                Py_ssize_t* shape, const char* name) {
+  Py_buffer view;
+  if (PyObject_GetBuffer(obj, &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) {
+    return false;
+  }
+  const char* format = view.format;
+  if ((*format == '@') || (*format == '=')) {
+    ++format;
+  }
+  bool ok = (view.ndim == ndim) && (std::strlen(format) == 1);
+  bool in_range = true;
+  for (int d = 0; ok && (d < ndim); ++d) {
+    shape[d] = view.shape[d];
+  }
+  if (ok) {
+    Py_ssize_t n = view.len / view.itemsize;
+    out.resize(n);
+    const char* data = static_cast<const char*>(view.buf);
+    for (Py_ssize_t i = 0; ok && in_range && (i < n); ++i) {
+      const char* item = data + i * view.itemsize;
+      switch (*format) {
+        case 'b': in_range = convertItem<int8_t>(item, out[i]); break;
+        case 'B': in_range = convertItem<uint8_t>(item, out[i]); break;
+        case 'h': in_range = convertItem<int16_t>(item, out[i]); break;
+        case 'H': in_range = convertItem<uint16_t>(item, out[i]); break;
+        case 'i': in_range = convertItem<int32_t>(item, out[i]); break;
+        case 'I': in_range = convertItem<uint32_t>(item, out[i]); break;
+        case 'l': in_range = convertItem<long>(item, out[i]); break;
+        case 'L': in_range = convertItem<unsigned long>(item, out[i]); break;
+        case 'q': in_range = convertItem<long long>(item, out[i]); break;
+        case 'Q':
+          in_range = convertItem<unsigned long long>(item, out[i]);
+          break;
+        case 'n': in_range = convertItem<Py_ssize_t>(item, out[i]); break;
+        case 'N': in_range = convertItem<size_t>(item, out[i]); break;
+        case 'f': in_range = convertItem<float>(item, out[i]); break;
+        case 'd': in_range = convertItem<double>(item, out[i]); break;
+        default: ok = false;
+      }
+    }
+  }
+  PyBuffer_Release(&view);
+  if (!ok) {
+    PyErr_Format(PyExc_TypeError,
+                 "%s must be a contiguous %d-dimensional numeric buffer", name,
+                 ndim);
+  } else if (!in_range) {
+    PyErr_Format(PyExc_ValueError, "%s holds a value out of range", name);
+  }
+  return ok && in_range;
+}
+
+// The largest number of seconds the clock holds, with room to add a time.
+const double kMaxSeconds =
+    std::chrono::duration<double>(time_duration::max()).count() / 2;
+
+time_duration fromSeconds(double seconds) {
+  if (seconds >= kMaxSeconds) {
+    return time_duration::max();
+  }
+  return std::chrono::duration_cast<time_duration>(
+      std::chrono::duration<double>(seconds));
+}
+
+///
+/// Fail if the model is running in another thread.
+///
+bool checkIdle(PyModel* self) {
+  if (self->running) {
+    PyErr_SetString(PyExc_RuntimeError,
+                    "The model is running in another thread");
+    return false;
+  }
+  return true;
+}
+
+///
+/// Fail if views of the memory exist, as the memory may move.
+///
+bool checkNoExports(PyModel* self, ViewKind kind = ViewKind::Reports) {
+  if (self->exports[static_cast<size_t>(kind)] > 0) {
+    PyErr_SetString(PyExc_BufferError,
+                    "Release the views of the model before changing it");
+    return false;
+  }
+  return true;
+}
+
+PyObject* PyModel_new(PyTypeObject* type, PyObject* args, PyObject* kwds) {
+  static const char* kwlist[] = {nullptr};
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "", const_cast<char**>(kwlist))) {
+    return nullptr;
+  }
+  PyModel* self = reinterpret_cast<PyModel*>(type->tp_alloc(type, 0));
+  if (!self) {
+    return nullptr;
+  }
+  try {
+    self->model = new Model();
+    self->person_states = new std::vector<uint8_t>();
+  } catch (...) {
+    setPythonError();
+    Py_DECREF(self);
+    return nullptr;
+  }
+  return reinterpret_cast<PyObject*>(self);
+}
+
+void PyModel_dealloc(PyModel* self) {
+  delete self->model;
+  delete self->person_states;
+  Py_TYPE(self)->tp_free(reinterpret_cast<PyObject*>(self));
+}
+
+PyObject* PyModel_setStartDate(PyModel* self, PyObject* args) {
+  int year, month, day;
+  if (!PyArg_ParseTuple(args, "iii", &year, &month, &day) ||
+      !checkIdle(self)) {
+    return nullptr;
+  }
+  self->model->setStartDate(year, month, day);
+  Py_RETURN_NONE;
+}
+
+PyObject* PyModel_seed(PyModel* self, PyObject* args) {
+  unsigned long long seed_value;
+  if (!PyArg_ParseTuple(args, "K", &seed_value) || !checkIdle(self)) {
+    return nullptr;
+  }
+  self->model->seed(seed_value);
+  Py_RETURN_NONE;
+}
+
+PyObject* PyModel_setTransmissionModel(PyModel* self, PyObject* args) {
+  const char* name;
+  if (!PyArg_ParseTuple(args, "s", &name) || !checkIdle(self)) {
+    return nullptr;
+  }
+  if (std::strcmp(name, "binomial") == 0) {
+    self->model->setTransmissionModel(TransmissionModel::Binomial);
+  } else if (std::strcmp(name, "exposure") == 0) {
+    self->model->setTransmissionModel(TransmissionModel::ExposureAccumulation);
+  } else {
+    PyErr_SetString(PyExc_ValueError,
+                    "The transmission model is 'binomial' or 'exposure'");
+    return nullptr;
+  }
+  Py_RETURN_NONE;
+}
+
+///
+/// add_locations(beta, names=None) -> int
+///
+/// Create a location for each beta (infections/day). Returns the id of the
+/// first new location; the rest follow consecutively.
+///
+PyObject* PyModel_addLocations(PyModel* self, PyObject* args,
+                               PyObject* kwds) {
+  static const char* kwlist[] = {"beta", "names", nullptr};
+  PyObject* beta_obj;
+  PyObject* names_obj = Py_None;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O|O",
+                                   const_cast<char**>(kwlist), &beta_obj,
+                                   &names_obj) ||
+      !checkIdle(self)) {
+    return nullptr;
+  }
+  std::vector<double> beta;
+  Py_ssize_t shape[1];
+  if (!readBuffer(beta_obj, 1, beta, shape, "beta")) {
+    return nullptr;
+  }
+  std::vector<std::string> names(beta.size());
+  if (names_obj != Py_None) {
+    PyObject* seq = PySequence_Fast(names_obj, "names must be a sequence");
+    if (!seq) {
+      return nullptr;
+    }
+    if (PySequence_Fast_GET_SIZE(seq) != static_cast<Py_ssize_t>(beta.size())) {
+      Py_DECREF(seq);
+      PyErr_SetString(PyExc_ValueError, "names and beta differ in length");
+      return nullptr;
+    }
+    for (size_t i = 0; i < names.size(); ++i) {
+      const char* name = PyUnicode_AsUTF8(PySequence_Fast_GET_ITEM(seq, i));
+      if (!name) {
+        Py_DECREF(seq);
+        return nullptr;
+      }
+      names[i] = name;
+    }
+    Py_DECREF(seq);
+  }
+  size_t first = self->model->numLocations();
+  for (size_t i = 0; i < beta.size(); ++i) {
+    self->model->createLocation(beta[i], names[i]);
+  }
+  return PyLong_FromSize_t(first);
+}
+
+///
+/// add_persons(home, durations) -> int
+///
+/// Create a person for each home location id. The durations are a 2-D array
+/// with a row per person and a column per duration of the disease model, in
+/// days. Infinite durations never pass. Returns the id of the first new
+/// person.
+///
+PyObject* PyModel_addPersons(PyModel* self, PyObject* args) {
+  PyObject* home_obj;
+  PyObject* durations_obj;
+  if (!PyArg_ParseTuple(args, "OO", &home_obj, &durations_obj) ||
+      !checkIdle(self)) {
+    return nullptr;
+  }
+  std::vector<uint32_t> home;
+  std::vector<double> durations;
+  Py_ssize_t home_shape[1];
+  Py_ssize_t durations_shape[2];
+  if (!readBuffer(home_obj, 1, home, home_shape, "home") ||
+      !readBuffer(durations_obj, 2, durations, durations_shape,
+                  "durations")) {
+    return nullptr;
+  }
+  if ((durations_shape[0] != home_shape[0]) ||
+      (durations_shape[1] != DiseaseModel::NumDurations)) {
+    PyErr_Format(PyExc_ValueError,
+                 "durations must have a row per person and %d columns",
+                 static_cast<int>(DiseaseModel::NumDurations));
+    return nullptr;
+  }
+  // Check the whole batch first, so a bad row adds nobody.
+  for (uint32_t id : home) {
+    if (id >= self->model->numLocations()) {
+      PyErr_SetString(PyExc_IndexError, "Location not found");
+      return nullptr;
+    }
+  }
+  size_t first = self->model->numPersons();
+  try {
+    for (size_t i = 0; i < home.size(); ++i) {
+      DiseaseDurations person_durations;
+      for (size_t d = 0; d < DiseaseModel::NumDurations; ++d) {
+        person_durations[d] =
+            fromSeconds(durations[i * DiseaseModel::NumDurations + d] * 86400);
+      }
+      self->model->createPerson(self->model->getLocation(home[i]),
+                                person_durations);
+    }
+  } catch (...) {
+    setPythonError();
+    return nullptr;
+  }
+  return PyLong_FromSize_t(first);
+}
+
+///
+/// add_itinerary(person, location, start, end)
+///
+/// Add itinerary entries in bulk. The start and end times are in seconds
+/// from the current simulation time.
+///
+PyObject* PyModel_addItinerary(PyModel* self, PyObject* args) {
+  PyObject *person_obj, *location_obj, *start_obj, *end_obj;
+  if (!PyArg_ParseTuple(args, "OOOO", &person_obj, &location_obj, &start_obj,
+                        &end_obj) ||
+      !checkIdle(self)) {
+    return nullptr;
+  }
+  std::vector<uint32_t> person, location;
+  std::vector<double> start, end;
+  Py_ssize_t shape[1];
+  if (!readBuffer(person_obj, 1, person, shape, "person") ||
+      !readBuffer(location_obj, 1, location, shape, "location") ||
+      !readBuffer(start_obj, 1, start, shape, "start") ||
+      !readBuffer(end_obj, 1, end, shape, "end")) {
+    return nullptr;
+  }
+  if ((location.size() != person.size()) || (start.size() != person.size()) ||
+      (end.size() != person.size())) {
+    PyErr_SetString(PyExc_ValueError, "The arrays differ in length");
+    return nullptr;
+  }
+  // Check the whole batch first, so a bad row adds no entries.
+  for (size_t i = 0; i < person.size(); ++i) {
+    if (person[i] >= self->model->numPersons()) {
+      PyErr_SetString(PyExc_IndexError, "Person not found");
+      return nullptr;
+    }
+    if (location[i] >= self->model->numLocations()) {
+      PyErr_SetString(PyExc_IndexError, "Location not found");
+      return nullptr;
+    }
+    if (!(std::fabs(start[i]) < kMaxSeconds) ||
+        !(std::fabs(end[i]) < kMaxSeconds)) {
+      PyErr_SetString(PyExc_ValueError, "The times are out of range");
+      return nullptr;
+    }
+  }
+  time_pt now = self->model->currentTime();
+  try {
+    for (size_t i = 0; i < person.size(); ++i) {
+      self->model->getPerson(person[i]).addItineraryEntry(
+          ItineraryEntry(self->model->getLocation(location[i]),
+                         now + fromSeconds(start[i]),
+                         now + fromSeconds(end[i])));
+    }
+  } catch (...) {
+    setPythonError();
+    return nullptr;
+  }
+  Py_RETURN_NONE;
+}
+
+///
+/// infect(persons)
+///
+PyObject* PyModel_infect(PyModel* self, PyObject* args) {
+  PyObject* person_obj;
+  if (!PyArg_ParseTuple(args, "O", &person_obj) || !checkIdle(self)) {
+    return nullptr;
+  }
+  std::vector<uint32_t> person;
+  Py_ssize_t shape[1];
+  if (!readBuffer(person_obj, 1, person, shape, "persons")) {
+    return nullptr;
+  }
+  for (uint32_t id : person) {
+    if (id >= self->model->numPersons()) {
+      PyErr_SetString(PyExc_IndexError, "Person not found");
+      return nullptr;
+    }
+  }
+  try {
+    for (uint32_t id : person) {
+      self->model->getPerson(id).infect();
+    }
+  } catch (...) {
+    setPythonError();
+    return nullptr;
+  }
+  Py_RETURN_NONE;
+}
+
+///
+/// simulate(days)
+///
+/// The interpreter lock is released while the model runs.
+///
+PyObject* PyModel_simulate(PyModel* self, PyObject* args) {
+  double days;
+  if (!PyArg_ParseTuple(args, "d", &days) || !checkIdle(self) ||
+      !checkNoExports(self)) {
+    return nullptr;
+  }
+  bool failed = false;
+  std::string error;
+  self->running = true;
+  Py_BEGIN_ALLOW_THREADS
+  try {
+    self->model->simulate(fromSeconds(days * 86400));
+  } catch (const std::exception& e) {
+    failed = true;
+    error = e.what();
+  }
+  Py_END_ALLOW_THREADS
+  self->running = false;
+  if (failed) {
+    PyErr_SetString(PyExc_RuntimeError, error.c_str());
+    return nullptr;
+  }
+  Py_RETURN_NONE;
+}
+
+PyObject* PyModel_callWithPath(PyModel* self, PyObject* args,
+                               void (Model::*method)(const std::string&),
+                               bool changes_model) {
+  const char* path;
+  if (!PyArg_ParseTuple(args, "s", &path) || !checkIdle(self)) {
+    return nullptr;
+  }
+  if (changes_model && !checkNoExports(self)) {
+    return nullptr;
+  }
+  try {
+    (self->model->*method)(path);
+  } catch (...) {
+    setPythonError();
+    return nullptr;
+  }
+  Py_RETURN_NONE;
+}
+
+PyObject* PyModel_loadScenario(PyModel* self, PyObject* args) {
+  return PyModel_callWithPath(self, args, &Model::loadScenario, true);
+}
+
+PyObject* PyModel_saveScenario(PyModel* self, PyObject* args) {
+  return PyModel_callWithPath(self, args, &Model::saveScenario, false);
+}
+
+PyObject* PyModel_saveCheckpoint(PyModel* self, PyObject* args) {
+  return PyModel_callWithPath(self, args, &Model::saveCheckpoint, false);
+}
+
+PyObject* PyModel_loadCheckpoint(PyModel* self, PyObject* args) {
+  return PyModel_callWithPath(self, args, &Model::loadCheckpoint, true);
+}
+
+PyObject* makeView(PyModel* self, ViewKind kind) {
+  PyArrayView* view = PyObject_New(PyArrayView, &PyArrayViewType);
+  if (!view) {
+    return nullptr;
+  }
+  Py_INCREF(self);
+  view->owner = self;
+  view->kind = kind;
+  PyObject* memory_view = PyMemoryView_FromObject(
+      reinterpret_cast<PyObject*>(view));
+  Py_DECREF(view);
+  return memory_view;
+}
+
+///
+/// reports() -> memoryview
+///
+/// The daily reports as a read-only (days, states) view of uint32 counts.
+///
+PyObject* PyModel_reports(PyModel* self, PyObject*) {
+  if (!checkIdle(self)) {
+    return nullptr;
+  }
+  return makeView(self, ViewKind::Reports);
+}
+
+///
+/// person_states() -> memoryview
+///
+/// The state index of every person, in id order, as a read-only uint8 view.
+/// The persons are not stored contiguously, so the states are gathered into
+/// an array owned by the model first.
+///
+PyObject* PyModel_personStates(PyModel* self, PyObject*) {
+  if (!checkIdle(self) || !checkNoExports(self, ViewKind::PersonStates)) {
+    return nullptr;
+  }
+  auto& states = *self->person_states;
+  states.resize(self->model->numPersons());
+  for (size_t i = 0; i < states.size(); ++i) {
+    states[i] = stateIndex(self->model->getPerson(i).infectionState());
+  }
+  return makeView(self, ViewKind::PersonStates);
+}
+
+PyObject* PyModel_numPersons(PyModel* self, PyObject*) {
+  if (!checkIdle(self)) {
+    return nullptr;
+  }
+  return PyLong_FromSize_t(self->model->numPersons());
+}
+
+PyObject* PyModel_numLocations(PyModel* self, PyObject*) {
+  if (!checkIdle(self)) {
+    return nullptr;
+  }
+  return PyLong_FromSize_t(self->model->numLocations());
+}
+
+PyMethodDef PyModel_methods[] = {
+    {"set_start_date", reinterpret_cast<PyCFunction>(PyModel_setStartDate),
+     METH_VARARGS, "set_start_date(year, month, day)"},
+    {"seed", reinterpret_cast<PyCFunction>(PyModel_seed), METH_VARARGS,
+     "seed(value)"},
+    {"set_transmission_model",
+     reinterpret_cast<PyCFunction>(PyModel_setTransmissionModel), METH_VARARGS,
+     "set_transmission_model('binomial' or 'exposure')"},
+    {"add_locations", reinterpret_cast<PyCFunction>(PyModel_addLocations),
+     METH_VARARGS | METH_KEYWORDS,
+     "add_locations(beta, names=None) -> id of the first location"},
+    {"add_persons", reinterpret_cast<PyCFunction>(PyModel_addPersons),
+     METH_VARARGS,
+     "add_persons(home, durations) -> id of the first person; durations in "
+     "days"},
+    {"add_itinerary", reinterpret_cast<PyCFunction>(PyModel_addItinerary),
+     METH_VARARGS,
+     "add_itinerary(person, location, start, end); seconds from now"},
+    {"infect", reinterpret_cast<PyCFunction>(PyModel_infect), METH_VARARGS,
+     "infect(persons)"},
+    {"simulate", reinterpret_cast<PyCFunction>(PyModel_simulate), METH_VARARGS,
+     "simulate(days)"},
+    {"load_scenario", reinterpret_cast<PyCFunction>(PyModel_loadScenario),
+     METH_VARARGS, "load_scenario(path)"},
+    {"save_scenario", reinterpret_cast<PyCFunction>(PyModel_saveScenario),
+     METH_VARARGS, "save_scenario(path)"},
+    {"save_checkpoint", reinterpret_cast<PyCFunction>(PyModel_saveCheckpoint),
+     METH_VARARGS, "save_checkpoint(path)"},
+    {"load_checkpoint", reinterpret_cast<PyCFunction>(PyModel_loadCheckpoint),
+     METH_VARARGS, "load_checkpoint(path)"},
+    {"reports", reinterpret_cast<PyCFunction>(PyModel_reports), METH_NOARGS,
+     "reports() -> read-only (days, states) uint32 view"},
+    {"person_states", reinterpret_cast<PyCFunction>(PyModel_personStates),
+     METH_NOARGS, "person_states() -> read-only uint8 view"},
+    {"num_persons", reinterpret_cast<PyCFunction>(PyModel_numPersons),
+     METH_NOARGS, "num_persons() -> int"},
+    {"num_locations", reinterpret_cast<PyCFunction>(PyModel_numLocations),
+     METH_NOARGS, "num_locations() -> int"},
+    {nullptr, nullptr, 0, nullptr}};
+
+int PyArrayView_getBuffer(PyArrayView* self, Py_buffer* view, int flags) {
+  if (flags & PyBUF_WRITABLE) {
+    PyErr_SetString(PyExc_BufferError, "The views of a model are read-only");
+    return -1;
+  }
+  if (!checkIdle(self->owner)) {
+    return -1;
+  }
+  static uint32_t empty = 0;
+  Model& model = *self->owner->model;
+  if (self->kind == ViewKind::Reports) {
+    ReportSpan reports = model.dailyReports();
+    self->shape[0] = reports.size;
+    self->shape[1] = DiseaseModel::num_states;
+    self->strides[0] = sizeof(SeirReport);
+    self->strides[1] = sizeof(uint32_t);
+    view->buf = reports.size > 0 ? const_cast<SeirReport*>(reports.data)
+                                 : static_cast<void*>(&empty);
+    view->itemsize = sizeof(uint32_t);
+    view->ndim = 2;
+    view->format = const_cast<char*>("I");
+  } else {
+    auto& states = *self->owner->person_states;
+    self->shape[0] = states.size();
+    self->strides[0] = sizeof(uint8_t);
+    view->buf = states.size() > 0 ? static_cast<void*>(states.data())
+                                  : static_cast<void*>(&empty);
+    view->itemsize = sizeof(uint8_t);
+    view->ndim = 1;
+    view->format = const_cast<char*>("B");
+  }
+  view->len = view->itemsize;
+  for (int d = 0; d < view->ndim; ++d) {
+    view->len *= self->shape[d];
+  }
+  view->readonly = 1;
+  view->shape = self->shape;
+  view->strides = self->strides;
+  view->suboffsets = nullptr;
+  view->internal = nullptr;
+  view->obj = reinterpret_cast<PyObject*>(self);
+  Py_INCREF(self);
+  self->owner->exports[static_cast<size_t>(self->kind)]++;
+  return 0;
+}
+
+void PyArrayView_releaseBuffer(PyArrayView* self, Py_buffer*) {
+  self->owner->exports[static_cast<size_t>(self->kind)]--;
+}
+
+void PyArrayView_dealloc(PyArrayView* self) {
+  Py_DECREF(self->owner);
+  PyObject_Free(self);
+}
+
+PyBufferProcs PyArrayView_bufferProcs = {
+    reinterpret_cast<getbufferproc>(PyArrayView_getBuffer),
+    reinterpret_cast<releasebufferproc>(PyArrayView_releaseBuffer)};
+
+PyModuleDef epideux_module = {PyModuleDef_HEAD_INIT, "epideux",
+                              "Agent based location-graph epidemic simulation",
+                              -1, nullptr};
+
+}  // namespace
+
+PyMODINIT_FUNC PyInit_epideux() {
+  PyModelType.tp_name = "epideux.Model";
+  PyModelType.tp_doc = "An epidemic simulation model";
+  PyModelType.tp_basicsize = sizeof(PyModel);
+  PyModelType.tp_flags = Py_TPFLAGS_DEFAULT;
+  PyModelType.tp_new = PyModel_new;
+  PyModelType.tp_dealloc = reinterpret_cast<destructor>(PyModel_dealloc);
+  PyModelType.tp_methods = PyModel_methods;
+  if (PyType_Ready(&PyModelType) < 0) {
+    return nullptr;
+  }
+
+  PyArrayViewType.tp_name = "epideux._ArrayView";
+  PyArrayViewType.tp_basicsize = sizeof(PyArrayView);
+  PyArrayViewType.tp_flags = Py_TPFLAGS_DEFAULT;
+  PyArrayViewType.tp_dealloc =
+      reinterpret_cast<destructor>(PyArrayView_dealloc);
+  PyArrayViewType.tp_as_buffer = &PyArrayView_bufferProcs;
+  if (PyType_Ready(&PyArrayViewType) < 0) {
+    return nullptr;
+  }
+
+  PyObject* module = PyModule_Create(&epideux_module);
+  if (!module) {
+    return nullptr;
+  }
+  PyObject* state_names = PyTuple_New(DiseaseModel::num_states);
+  for (size_t i = 0; i < DiseaseModel::num_states; ++i) {
+    PyTuple_SET_ITEM(state_names, i,
+                     PyUnicode_FromString(DiseaseModel::state_names[i]));
+  }
+  Py_INCREF(&PyModelType);
+  if ((PyModule_AddObject(module, "Model",
+                          reinterpret_cast<PyObject*>(&PyModelType)) < 0) ||
+      (PyModule_AddObject(module, "states", state_names) < 0) ||
+      (PyModule_AddIntConstant(module, "num_durations",
+                               DiseaseModel::NumDurations) < 0)) {
+    Py_DECREF(module);
+    return nullptr;
+  }
+  return module;
+}
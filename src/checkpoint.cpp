@@ -0,0 +1,451 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include "epideux/epideux.h"
+
+namespace epideux {
+
+namespace {
+
+constexpr char kCheckpointMagic[8] = {'E', 'P', 'I', 'D', 'E', 'U', 'X', 'C'};
+constexpr uint32_t kCheckpointVersion = 1;
+constexpr uint32_t kNone = std::numeric_limits<uint32_t>::max();
+
+struct CheckpointHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t num_states;
+  uint32_t num_durations;
+  uint32_t transmission_model;
+  uint64_t num_locations;
+  uint64_t num_persons;
+  uint64_t num_itinerary_entries;
+  int64_t current_time;
+};
+
+struct CheckpointPerson {
+  uint32_t id;
+  uint32_t location;
+  uint32_t location_slot;
+  uint32_t active_itinerary_entry;
+  int64_t state_entered;
+  double infectiousness;
+  double susceptibility;
+  double exposure_mark;
+  uint8_t state;
+  uint8_t reserved[7];
+};
+
+struct CheckpointLocation {
+  int64_t last_update;
+  int64_t last_pressure_update;
+  double beta_per_sec;
+  double pressure_integral;
+  uint64_t num_occupants;
+  uint64_t num_slots;
+  uint64_t num_free_slots;
+};
+
+struct CheckpointEvent {
+  int64_t scheduled_time;
+  uint32_t person;
+  uint32_t itinerary_entry;
+  uint8_t event;
+  uint8_t reserved[7];
+};
+
+int64_t toTicks(time_pt t) { return t.time_since_epoch().count(); }
+
+time_pt fromTicks(int64_t ticks) { return time_pt(time_duration(ticks)); }
+
+template <typename T>
+void writeValue(std::ostream& out, const T& value) {
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+void writeArray(std::ostream& out, const std::vector<T>& v) {
+  writeValue<uint64_t>(out, v.size());
+  out.write(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(T));
+}
+
+template <typename T>
+T readValue(std::istream& in) {
+  T value;
+  if (!in.read(reinterpret_cast<char*>(&value), sizeof(T))) {
+    throw std::runtime_error("Truncated checkpoint file");
+  }
+  return value;
+}
+
+template <typename T>
+std::vector<T> readArray(std::istream& in, uint64_t max_size) {
+  uint64_t size = readValue<uint64_t>(in);
+  if (size > max_size) {
+    throw std::runtime_error("Corrupt checkpoint file");
+  }
+  std::vector<T> v(size);
+  if (!in.read(reinterpret_cast<char*>(v.data()), size * sizeof(T))) {
+    throw std::runtime_error("Truncated checkpoint file");
+  }
+  return v;
+}
+
+}  // namespace
+
+///
+/// Write the complete state of the simulation to a checkpoint file.
+///
+/// The checkpoint holds the simulated time, the infection state and weights
+/// of every person, the occupants of every location, the pending events in
+/// the schedule, the reports and the state of the random generators. The
+/// scenario itself, i.e., the locations, persons and itineraries, is not
+/// written; it is referred to by index. Call this between runs of simulate().
+///
+/// @param path The path of the checkpoint file.
+///
+void Model::saveCheckpoint(const std::string& path) {
+  if (simulation_running_ || fixed_step_running_) {
+    throw std::logic_error("Cannot checkpoint a running simulation");
+  }
+
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    throw std::runtime_error("Could not open checkpoint file " + path);
+  }
+
+  uint64_t num_itinerary_entries = 0;
+  for (auto& p : persons_) {
+    num_itinerary_entries += p.itinerary_.size();
+  }
+
+  CheckpointHeader header = {};
+  std::copy(std::begin(kCheckpointMagic), std::end(kCheckpointMagic),
+            header.magic);
+  header.version = kCheckpointVersion;
+  header.num_states = DiseaseModel::num_states;
+  header.num_durations = DiseaseModel::NumDurations;
+  header.transmission_model = static_cast<uint32_t>(transmission_model_);
+  header.num_locations = locations_.size();
+  header.num_persons = persons_.size();
+  header.num_itinerary_entries = num_itinerary_entries;
+  header.current_time = toTicks(current_sim_time_);
+  writeValue(out, header);
+
+  // Itinerary entries are referred to by their position in the person's
+  // itinerary. The positions are looked up one person at a time, so saving
+  // only takes memory for the pending events and the longest itinerary. The
+  // pending events that refer to an entry are ordered by person for this.
+  size_t num_pending = schedule_.size() - schedule_head_;
+  std::vector<std::pair<uint32_t, size_t>> entry_events;
+  for (size_t i = 0; i < num_pending; ++i) {
+    const ScheduleEntry& entry = schedule_[schedule_head_ + i];
+    if (entry.itinerary_entry) {
+      entry_events.emplace_back(entry.person->id_, i);
+    }
+  }
+  std::sort(entry_events.begin(), entry_events.end());
+  std::vector<uint32_t> event_entry_index(num_pending, kNone);
+  std::vector<std::pair<const ItineraryEntry*, uint32_t>> positions;
+  auto position_of = [&positions](const ItineraryEntry* entry) {
+    auto it = std::lower_bound(positions.begin(), positions.end(),
+                               std::make_pair(entry, uint32_t(0)));
+    if ((it == positions.end()) || (it->first != entry)) {
+      throw std::logic_error("Itinerary entry not in the person's itinerary");
+    }
+    return it->second;
+  };
+
+  // The persons are visited in the order of their ids, like the events.
+  std::vector<CheckpointPerson> persons;
+  persons.reserve(persons_.size());
+  auto next_event = entry_events.begin();
+  for (Person* p : person_index_) {
+    positions.clear();
+    uint32_t position = 0;
+    for (auto& e : p->itinerary_) {
+      positions.emplace_back(&e, position++);
+    }
+    std::sort(positions.begin(), positions.end());
+    for (; (next_event != entry_events.end()) && (next_event->first == p->id_);
+         ++next_event) {
+      event_entry_index[next_event->second] = position_of(
+          schedule_[schedule_head_ + next_event->second].itinerary_entry);
+    }
+
+    CheckpointPerson person = {};
+    person.id = p->id_;
+    person.location = p->current_location->id();
+    person.location_slot = p->location_slot_;
+    person.active_itinerary_entry =
+        p->active_itinerary_entry_ ? position_of(p->active_itinerary_entry_)
+                                   : kNone;
+    person.state_entered = toTicks(p->state_entered_);
+    person.infectiousness = p->infectiousness_;
+    person.susceptibility = p->susceptibility_;
+    person.exposure_mark = p->exposure_mark_;
+    person.state = stateIndex(p->infection_state_);
+    persons.push_back(person);
+  }
+  writeArray(out, persons);
+
+  for (auto& l : locations_) {
+    CheckpointLocation location = {};
+    location.last_update = toTicks(l.last_update_);
+    location.last_pressure_update = toTicks(l.last_pressure_update_);
+    location.beta_per_sec = l.beta_per_sec_;
+    location.pressure_integral = l.pressure_integral_;
+    writeValue(out, location);
+    // The occupants are written in the order they entered.
+    std::vector<uint32_t> occupants;
+    occupants.reserve(l.persons_.size());
+    for (auto* p : l.persons_) {
+      occupants.push_back(p->id_);
+    }
+    writeArray(out, occupants);
+    writeValue<uint64_t>(out, l.slot_persons_.size());
+    writeArray(out, l.free_slots_);
+    l.susceptibility_tree_.save(out);
+    l.infectiousness_tree_.save(out);
+  }
+
+  std::vector<CheckpointEvent> events;
+  events.reserve(schedule_.size() - schedule_head_);
+  for (size_t i = schedule_head_; i < schedule_.size(); ++i) {
+    const ScheduleEntry& entry = schedule_[i];
+    CheckpointEvent event = {};
+    event.scheduled_time = toTicks(entry.scheduled_time);
+    event.event = static_cast<uint8_t>(entry.event);
+    event.person = entry.person ? entry.person->id_ : kNone;
+    event.itinerary_entry = event_entry_index[i - schedule_head_];
+    events.push_back(event);
+  }
+  writeArray(out, events);
+
+  writeValue(out, latest_report_);
+  writeArray(out, daily_reports_);
+
+  std::ostringstream random_state;
+  random_state << random_generator_ << ' ' << random_buffer_;
+  std::string random_text = random_state.str();
+  writeValue<uint64_t>(out, random_text.size());
+  out.write(random_text.data(), random_text.size());
+
+  if (!out) {
+    throw std::runtime_error("Could not write checkpoint file " + path);
+  }
+}
+
+///
+/// Restore the state of the simulation from a checkpoint file.
+///
+/// The model must hold the same scenario as when the checkpoint was written,
+/// e.g., loaded from the same scenario file. Continuing the simulation then
+/// gives the same results as if it had never stopped. Report sinks, the
+/// location recorder, the event trace and the transmission log are not part
+/// of the checkpoint. If the file turns out to be corrupt, an exception is
+/// thrown and the model should be discarded.
+///
+/// @param path The path of the checkpoint file.
+///
+void Model::loadCheckpoint(const std::string& path) {
+  if (simulation_running_ || fixed_step_running_) {
+    throw std::logic_error("Cannot restore a running simulation");
+  }
+  std::ifstream in(path, std::ios::binary | std::ios::ate);
+  if (!in) {
+    throw std::runtime_error("Could not open checkpoint file " + path);
+  }
+  uint64_t file_size = in.tellg();
+  in.seekg(0);
+
+  // Index the scenario the checkpoint refers to.
+  std::vector<Location*> locations;
+  locations.reserve(locations_.size());
+  for (auto& l : locations_) {
+    locations.push_back(&l);
+  }
+  std::vector<Person*> persons;
+  persons.reserve(persons_.size());
+  std::vector<std::vector<ItineraryEntry*>> itineraries;
+  itineraries.reserve(persons_.size());
+  uint64_t num_itinerary_entries = 0;
+  for (auto& p : persons_) {
+    if (p.id_ >= persons.size()) {
+      persons.resize(p.id_ + 1, nullptr);
+      itineraries.resize(p.id_ + 1);
+    }
+    persons[p.id_] = &p;
+    for (auto& e : p.itinerary_) {
+      itineraries[p.id_].push_back(&e);
+    }
+    num_itinerary_entries += p.itinerary_.size();
+  }
+  auto person_at = [&persons](uint32_t id) {
+    if ((id >= persons.size()) || !persons[id]) {
+      throw std::runtime_error("Corrupt checkpoint file");
+    }
+    return persons[id];
+  };
+  auto entry_at = [&itineraries](uint32_t id, uint32_t index) {
+    if (index == kNone) {
+      return static_cast<ItineraryEntry*>(nullptr);
+    }
+    if (index >= itineraries[id].size()) {
+      throw std::runtime_error("Corrupt checkpoint file");
+    }
+    return itineraries[id][index];
+  };
+
+  auto header = readValue<CheckpointHeader>(in);
+  if (!std::equal(std::begin(kCheckpointMagic), std::end(kCheckpointMagic),
+                  header.magic) ||
+      (header.version != kCheckpointVersion)) {
+    throw std::runtime_error("Not a checkpoint file: " + path);
+  }
+  if ((header.num_states != DiseaseModel::num_states) ||
+      (header.num_durations != DiseaseModel::NumDurations)) {
+    throw std::runtime_error(
+        "Checkpoint file was written for another disease model");
+  }
+  if ((header.num_locations != locations_.size()) ||
+      (header.num_persons != persons_.size()) ||
+      (header.num_itinerary_entries != num_itinerary_entries)) {
+    throw std::runtime_error("Checkpoint file is for another scenario");
+  }
+
+  // Read the persons before anything in the model is changed.
+  auto saved_persons =
+      readArray<CheckpointPerson>(in, header.num_persons);
+  if (saved_persons.size() != persons_.size()) {
+    throw std::runtime_error("Corrupt checkpoint file");
+  }
+  for (auto& saved : saved_persons) {
+    person_at(saved.id);
+    entry_at(saved.id, saved.active_itinerary_entry);
+    if ((saved.location >= locations.size()) ||
+        (saved.state >= DiseaseModel::num_states)) {
+      throw std::runtime_error("Corrupt checkpoint file");
+    }
+  }
+
+  transmission_model_ =
+      static_cast<TransmissionModel>(header.transmission_model);
+  current_sim_time_ = fromTicks(header.current_time);
+  for (auto& saved : saved_persons) {
+    Person& p = *persons[saved.id];
+    p.infection_state_ = static_cast<InfectionCategory>(saved.state);
+    p.state_entered_ = fromTicks(saved.state_entered);
+    p.infectiousness_ = saved.infectiousness;
+    p.susceptibility_ = saved.susceptibility;
+    p.exposure_mark_ = saved.exposure_mark;
+    p.active_itinerary_entry_ =
+        entry_at(saved.id, saved.active_itinerary_entry);
+    p.current_location = locations[saved.location];
+    p.location_slot_ = saved.location_slot;
+  }
+
+  // Rebuild the occupants of the locations and their sums from the persons.
+  for (auto* l : locations) {
+    auto saved = readValue<CheckpointLocation>(in);
+    l->last_update_ = fromTicks(saved.last_update);
+    l->last_pressure_update_ = fromTicks(saved.last_pressure_update);
+    l->beta_per_sec_ = saved.beta_per_sec;
+    l->pressure_integral_ = saved.pressure_integral;
+    auto occupants = readArray<uint32_t>(in, header.num_persons);
+    uint64_t num_slots = readValue<uint64_t>(in);
+    if (num_slots > header.num_persons) {
+      throw std::runtime_error("Corrupt checkpoint file");
+    }
+    l->free_slots_ = readArray<uint32_t>(in, num_slots);
+    l->persons_.clear();
+    l->slot_persons_.assign(num_slots, nullptr);
+    l->counts_ = SeirReport();
+    l->num_susceptible_ = 0;
+    l->num_infectious_ = 0;
+    for (uint32_t id : occupants) {
+      Person* p = person_at(id);
+      if ((p->current_location != l) || (p->location_slot_ >= num_slots)) {
+        throw std::runtime_error("Corrupt checkpoint file");
+      }
+      l->persons_.push_back(p);
+      p->location_it_ = std::prev(l->persons_.end());
+      l->slot_persons_[p->location_slot_] = p;
+      reportCount(l->counts_, p->infection_state_)++;
+      if (isSusceptible(p->infection_state_)) {
+        l->num_susceptible_++;
+      }
+      if (isInfectious(p->infection_state_)) {
+        l->num_infectious_++;
+      }
+    }
+    l->susceptibility_tree_.load(in);
+    l->infectiousness_tree_.load(in);
+    if ((l->susceptibility_tree_.size() != num_slots) ||
+        (l->infectiousness_tree_.size() != num_slots)) {
+      throw std::runtime_error("Corrupt checkpoint file");
+    }
+  }
+
+  auto events = readArray<CheckpointEvent>(in, 2 * num_itinerary_entries +
+                                                   (1u << 20));
+  schedule_.clear();
+  schedule_head_ = 0;
+  for (auto& event : events) {
+    if (event.event >= static_cast<uint8_t>(ScheduledEvent::NumEvents)) {
+      throw std::runtime_error("Corrupt checkpoint file");
+    }
+    ScheduleEntry entry = {fromTicks(event.scheduled_time),
+                           static_cast<ScheduledEvent>(event.event), nullptr,
+                           nullptr};
+    if (event.person != kNone) {
+      entry.person = person_at(event.person);
+      entry.itinerary_entry = entry_at(event.person, event.itinerary_entry);
+    }
+    schedule_.push_back(entry);
+  }
+
+  latest_report_ = readValue<SeirReport>(in);
+  // The number of reports is only limited by what is left of the file.
+  uint64_t remaining = file_size - static_cast<uint64_t>(in.tellg());
+  daily_reports_ = readArray<SeirReport>(in, remaining / sizeof(SeirReport));
+
+  uint64_t random_size = readValue<uint64_t>(in);
+  std::string random_text(random_size, '\0');
+  if (!in.read(&random_text[0], random_size)) {
+    throw std::runtime_error("Truncated checkpoint file");
+  }
+  std::istringstream random_state(random_text);
+  random_state >> random_generator_ >> random_buffer_;
+  if (!random_state) {
+    throw std::runtime_error("Corrupt checkpoint file");
+  }
+
+  // A recorder starts over from the restored locations.
+  setLocationRecorder(location_recorder_);
+}
+
+}  // namespace epideux
@@ -0,0 +1,376 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "epideux/epideux_c.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include "epideux/epideux.h"
+
+struct epideux_model {
+  epideux::Model model;
+  std::string last_error;
+};
+
+namespace {
+
+using namespace epideux;
+
+// Thrown when a buffer from the caller cannot hold the result.
+class BufferTooSmall : public std::runtime_error {
+ public:
+  BufferTooSmall() : std::runtime_error("Buffer too small") {}
+};
+
+// The largest number of seconds the clock holds, with room to add a time.
+const double kMaxSeconds =
+    std::chrono::duration<double>(time_duration::max()).count() / 2;
+
+///
+/// Check a time that is added to the clock.
+///
+void requireTime(double seconds) {
+  if (!(std::fabs(seconds) < kMaxSeconds)) {
+    throw std::out_of_range("The time is out of range");
+  }
+}
+
+///
+/// Check a disease duration, which may also be infinite.
+///
+void requireDuration(double seconds) {
+  if (std::isnan(seconds) || (seconds <= -kMaxSeconds)) {
+    throw std::out_of_range("The duration is out of range");
+  }
+}
+
+///
+/// Convert a checked time or duration. Durations beyond the clock never pass.
+///
+time_duration fromSeconds(double seconds) {
+  if (seconds >= kMaxSeconds) {
+    return time_duration::max();
+  }
+  return std::chrono::duration_cast<time_duration>(
+      std::chrono::duration<double>(seconds));
+}
+
+///
+/// Run a call into the engine, turning exceptions into a status and keeping
+/// the message on the model.
+///
+template <typename Call>
+epideux_status guarded(epideux_model* model, Call call) {
+  if (!model) {
+    return EPIDEUX_ERROR_INVALID_ARGUMENT;
+  }
+  try {
+    call(model->model);
+    model->last_error.clear();
+    return EPIDEUX_OK;
+  } catch (const BufferTooSmall& e) {
+    model->last_error = e.what();
+    return EPIDEUX_ERROR_BUFFER_TOO_SMALL;
+  } catch (const std::out_of_range& e) {
+    model->last_error = e.what();
+    return EPIDEUX_ERROR_OUT_OF_RANGE;
+  } catch (const std::logic_error& e) {
+    model->last_error = e.what();
+    return EPIDEUX_ERROR_INVALID_ARGUMENT;
+  } catch (const std::exception& e) {
+    model->last_error = e.what();
+    return EPIDEUX_ERROR_RUNTIME;
+  } catch (...) {
+    model->last_error = "Unknown error";
+    return EPIDEUX_ERROR_RUNTIME;
+  }
+}
+
+void requireArray(const void* array, size_t count) {
+  if (!array && (count > 0)) {
+    throw std::invalid_argument("Missing array");
+  }
+}
+
+void requireCapacity(size_t capacity, size_t needed) {
+  if (capacity < needed) {
+    throw BufferTooSmall();
+  }
+}
+
+}  // namespace
+
+uint32_t epideux_abi_version(void) { return EPIDEUX_C_ABI_VERSION; }
+
+uint32_t epideux_num_states(void) { return DiseaseModel::num_states; }
+
+uint32_t epideux_num_durations(void) { return DiseaseModel::NumDurations; }
+
+const char* epideux_state_name(uint32_t state) {
+  if (state >= DiseaseModel::num_states) {
+    return nullptr;
+  }
+  return DiseaseModel::state_names[state];
+}
+
+epideux_model* epideux_model_create(void) {
+  try {
+    return new epideux_model();
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void epideux_model_destroy(epideux_model* model) { delete model; }
+
+const char* epideux_last_error(const epideux_model* model) {
+  return model ? model->last_error.c_str() : "No model";
+}
+
+epideux_status epideux_set_start_date(epideux_model* model, int year,
+                                      int month, int day) {
+  return guarded(model,
+                 [&](Model& m) { m.setStartDate(year, month, day); });
+}
+
+epideux_status epideux_seed(epideux_model* model, uint64_t seed_value) {
+  return guarded(model, [&](Model& m) { m.seed(seed_value); });
+}
+
+epideux_status epideux_set_transmission_model(
+    epideux_model* model, epideux_transmission_model transmission_model) {
+  return guarded(model, [&](Model& m) {
+    switch (transmission_model) {
+      case EPIDEUX_TRANSMISSION_BINOMIAL:
+        m.setTransmissionModel(TransmissionModel::Binomial);
+        break;
+      case EPIDEUX_TRANSMISSION_EXPOSURE_ACCUMULATION:
+        m.setTransmissionModel(TransmissionModel::ExposureAccumulation);
+        break;
+      default:
+        throw std::invalid_argument("Unknown transmission model");
+    }
+  });
+}
+
+epideux_status epideux_add_locations(epideux_model* model, size_t count,
+                                     const double* beta, uint32_t* first_id) {
+  return guarded(model, [&](Model& m) {
+    requireArray(beta, count);
+    if (first_id) {
+      *first_id = m.numLocations();
+    }
+    for (size_t i = 0; i < count; ++i) {
+      m.createLocation(beta[i]);
+    }
+  });
+}
+
+epideux_status epideux_add_persons(epideux_model* model, size_t count,
+                                   const uint32_t* home,
+                                   const double* durations,
+                                   uint32_t* first_id) {
+  return guarded(model, [&](Model& m) {
+    requireArray(home, count);
+    requireArray(durations, count);
+    // Check the batch up front, so a bad row adds nobody.
+    for (size_t i = 0; i < count; ++i) {
+      if (home[i] >= m.numLocations()) {
+        throw std::out_of_range("Location not found");
+      }
+      for (size_t d = 0; d < DiseaseModel::NumDurations; ++d) {
+        requireDuration(durations[i * DiseaseModel::NumDurations + d]);
+      }
+    }
+    if (first_id) {
+      *first_id = m.numPersons();
+    }
+    for (size_t i = 0; i < count; ++i) {
+      DiseaseDurations person_durations;
+      for (size_t d = 0; d < DiseaseModel::NumDurations; ++d) {
+        person_durations[d] =
+            fromSeconds(durations[i * DiseaseModel::NumDurations + d]);
+      }
+      m.createPerson(m.getLocation(home[i]), person_durations);
+    }
+  });
+}
+
+epideux_status epideux_add_itinerary(epideux_model* model, size_t count,
+                                     const uint32_t* person,
+                                     const uint32_t* location,
+                                     const double* start, const double* end) {
+  return guarded(model, [&](Model& m) {
+    requireArray(person, count);
+    requireArray(location, count);
+    requireArray(start, count);
+    requireArray(end, count);
+    // Check the batch up front, so a bad row adds no entries.
+    for (size_t i = 0; i < count; ++i) {
+      if (person[i] >= m.numPersons()) {
+        throw std::out_of_range("Person not found");
+      }
+      if (location[i] >= m.numLocations()) {
+        throw std::out_of_range("Location not found");
+      }
+      requireTime(start[i]);
+      requireTime(end[i]);
+    }
+    time_pt now = m.currentTime();
+    for (size_t i = 0; i < count; ++i) {
+      m.getPerson(person[i]).addItineraryEntry(
+          ItineraryEntry(m.getLocation(location[i]), now + fromSeconds(start[i]),
+                         now + fromSeconds(end[i])));
+    }
+  });
+}
+
+epideux_status epideux_infect(epideux_model* model, size_t count,
+                              const uint32_t* person) {
+  return guarded(model, [&](Model& m) {
+    requireArray(person, count);
+    // Check the batch up front, so a bad id infects nobody.
+    for (size_t i = 0; i < count; ++i) {
+      if (person[i] >= m.numPersons()) {
+        throw std::out_of_range("Person not found");
+      }
+    }
+    for (size_t i = 0; i < count; ++i) {
+      m.getPerson(person[i]).infect();
+    }
+  });
+}
+
+epideux_status epideux_simulate(epideux_model* model, double duration) {
+  return guarded(model, [&](Model& m) {
+    requireTime(duration);
+    m.simulate(fromSeconds(duration));
+  });
+}
+
+epideux_status epideux_simulate_fixed_step(epideux_model* model,
+                                           double duration, double time_step) {
+  return guarded(model, [&](Model& m) {
+    requireTime(duration);
+    requireTime(time_step);
+    if (!(time_step > 0.0)) {
+      throw std::invalid_argument("The time step must be positive");
+    }
+    m.simulateFixedStep(fromSeconds(duration), fromSeconds(time_step));
+  });
+}
+
+epideux_status epideux_load_scenario(epideux_model* model, const char* path) {
+  return guarded(model, [&](Model& m) {
+    requireArray(path, 1);
+    m.loadScenario(path);
+  });
+}
+
+epideux_status epideux_save_scenario(epideux_model* model, const char* path) {
+  return guarded(model, [&](Model& m) {
+    requireArray(path, 1);
+    m.saveScenario(path);
+  });
+}
+
+epideux_status epideux_save_checkpoint(epideux_model* model,
+                                       const char* path) {
+  return guarded(model, [&](Model& m) {
+    requireArray(path, 1);
+    m.saveCheckpoint(path);
+  });
+}
+
+epideux_status epideux_load_checkpoint(epideux_model* model,
+                                       const char* path) {
+  return guarded(model, [&](Model& m) {
+    requireArray(path, 1);
+    m.loadCheckpoint(path);
+  });
+}
+
+size_t epideux_num_persons(const epideux_model* model) {
+  return model ? model->model.numPersons() : 0;
+}
+
+size_t epideux_num_locations(const epideux_model* model) {
+  return model ? model->model.numLocations() : 0;
+}
+
+size_t epideux_num_reports(const epideux_model* model) {
+  return model ? model->model.dailyReports().size : 0;
+}
+
+double epideux_current_time(const epideux_model* model) {
+  if (!model) {
+    return 0.0;
+  }
+  // currentTime() is not const.
+  time_pt now = const_cast<Model&>(model->model).currentTime();
+  return std::chrono::duration<double>(now.time_since_epoch()).count();
+}
+
+epideux_status epideux_get_report(epideux_model* model, uint32_t* out) {
+  return guarded(model, [&](Model& m) {
+    requireArray(out, 1);
+    SeirReport report = m.getReport();
+    for (size_t s = 0; s < DiseaseModel::num_states; ++s) {
+      out[s] = report.*DiseaseModel::report_fields[s];
+    }
+  });
+}
+
+epideux_status epideux_get_reports(epideux_model* model, uint32_t* out,
+                                   size_t capacity) {
+  return guarded(model, [&](Model& m) {
+    ReportSpan reports = m.dailyReports();
+    requireCapacity(capacity, reports.size);
+    requireArray(out, reports.size);
+    uint32_t* next = out;
+    for (const auto& report : reports) {
+      for (size_t s = 0; s < DiseaseModel::num_states; ++s) {
+        *next++ = report.*DiseaseModel::report_fields[s];
+      }
+    }
+  });
+}
+
+epideux_status epideux_get_person_states(epideux_model* model, uint8_t* out,
+                                         size_t capacity) {
+  return guarded(model, [&](Model& m) {
+    requireCapacity(capacity, m.numPersons());
+    requireArray(out, m.numPersons());
+    for (size_t i = 0; i < m.numPersons(); ++i) {
+      out[i] = stateIndex(m.getPerson(i).infectionState());
+    }
+  });
+}
+
+epideux_status epideux_get_person_locations(epideux_model* model,
+                                            uint32_t* out, size_t capacity) {
+  return guarded(model, [&](Model& m) {
+    requireCapacity(capacity, m.numPersons());
+    requireArray(out, m.numPersons());
+    for (size_t i = 0; i < m.numPersons(); ++i) {
+      out[i] = m.getPerson(i).currentLocation().id();
+    }
+  });
+}
@@ -0,0 +1,211 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "epideux/disease_model.h"
+#include "epideux/event_trace.h"
+
+namespace epideux {
+
+namespace {
+
+// Identifies the traces in the threads' buffer tables, as an address may be
+// reused by a later trace.
+std::atomic<uint64_t> next_trace_id(1);
+
+}  // namespace
+
+///
+/// @class EventTrace
+/// A binary trace of movement and infection events.
+///
+/// Each recording thread appends fixed-size records to its own buffer. Full
+/// buffers are handed to a background thread, which writes them to the file
+/// and returns them for reuse, so recording never waits for the disk. Use
+/// the epideux_trace_decode tool to turn a trace into text.
+///
+
+///
+/// Open a trace file and start the writer thread.
+///
+/// Failing writes throw a std::runtime_error from flush().
+///
+/// @param path The path of the trace file.
+/// @param buffer_records The number of records in each buffer.
+///
+EventTrace::EventTrace(const std::string& path, size_t buffer_records)
+    : id_(next_trace_id++), path_(path), buffer_records_(buffer_records) {
+  file_ = std::fopen(path.c_str(), "wb");
+  if (file_ == nullptr) {
+    throw std::runtime_error("Could not open trace file " + path);
+  }
+  TraceFileHeader header = {};
+  std::copy(std::begin(kTraceMagic), std::end(kTraceMagic), header.magic);
+  header.version = kTraceVersion;
+  header.record_size = sizeof(TraceRecord);
+  header.num_states = DiseaseModel::num_states;
+  if (std::fwrite(&header, sizeof(header), 1, file_) != 1) {
+    std::fclose(file_);
+    throw std::runtime_error("Could not write trace file " + path);
+  }
+  writer_ = std::thread(&EventTrace::writerLoop, this);
+}
+
+///
+/// Write all outstanding records and close the file. The model flushes the
+/// trace after every run, so errors are reported there; a failure here is
+/// ignored.
+///
+/// No thread may record while the trace is destroyed.
+///
+EventTrace::~EventTrace() {
+  try {
+    flush();
+  } catch (const std::runtime_error&) {
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  work_available_.notify_one();
+  writer_.join();
+  std::fclose(file_);
+}
+
+///
+/// Append a record to the calling thread's buffer.
+///
+void EventTrace::record(int64_t time, TraceEventKind kind, uint32_t person,
+                        uint32_t location, uint8_t state) {
+  ThreadBuffer& thread_buffer = threadBuffer();
+  thread_buffer.buffer->push_back({time, person, location, kind, state, {}});
+  if (thread_buffer.buffer->size() == buffer_records_) {
+    handOff(thread_buffer);
+  }
+}
+
+///
+/// Hand all partially filled buffers to the writer and wait for it to finish.
+///
+/// Only call this while no other thread is recording.
+///
+/// Throws a std::runtime_error if any records could not be written. The
+/// trace is then truncated, so every later flush throws as well.
+///
+void EventTrace::flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (auto& thread_buffer : thread_buffers_) {
+    if (!thread_buffer->buffer->empty()) {
+      full_buffers_.push_back(std::move(thread_buffer->buffer));
+      thread_buffer->buffer.reset(new Buffer());
+      thread_buffer->buffer->reserve(buffer_records_);
+    }
+  }
+  work_available_.notify_one();
+  work_done_.wait(lock, [this] { return full_buffers_.empty() && !writing_; });
+  write_failed_ |= std::fflush(file_) != 0;
+  if (write_failed_) {
+    throw std::runtime_error("Could not write trace file " + path_);
+  }
+}
+
+///
+/// Get the number of records written to the file so far.
+///
+uint64_t EventTrace::numRecords() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_records_;
+}
+
+///
+/// Find the calling thread's buffer for this trace, creating it if needed.
+///
+EventTrace::ThreadBuffer& EventTrace::threadBuffer() {
+  thread_local std::unordered_map<uint64_t, std::weak_ptr<ThreadBuffer>>
+      buffers;
+  thread_local uint64_t last_trace_id = 0;
+  thread_local ThreadBuffer* last_buffer = nullptr;
+  if (last_trace_id == id_) {
+    return *last_buffer;
+  }
+  auto& weak_buffer = buffers[id_];
+  std::shared_ptr<ThreadBuffer> thread_buffer = weak_buffer.lock();
+  if (!thread_buffer) {
+    thread_buffer = std::make_shared<ThreadBuffer>();
+    thread_buffer->buffer.reset(new Buffer());
+    thread_buffer->buffer->reserve(buffer_records_);
+    std::lock_guard<std::mutex> lock(mutex_);
+    thread_buffers_.push_back(thread_buffer);
+    weak_buffer = thread_buffer;
+  }
+  last_trace_id = id_;
+  last_buffer = thread_buffer.get();
+  return *thread_buffer;
+}
+
+///
+/// Queue a full buffer for writing and take an empty one.
+///
+void EventTrace::handOff(ThreadBuffer& thread_buffer) {
+  std::unique_ptr<Buffer> empty_buffer;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    full_buffers_.push_back(std::move(thread_buffer.buffer));
+    if (!free_buffers_.empty()) {
+      empty_buffer = std::move(free_buffers_.back());
+      free_buffers_.pop_back();
+    }
+  }
+  work_available_.notify_one();
+  if (!empty_buffer) {
+    empty_buffer.reset(new Buffer());
+    empty_buffer->reserve(buffer_records_);
+  }
+  thread_buffer.buffer = std::move(empty_buffer);
+}
+
+void EventTrace::writerLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (;;) {
+    work_available_.wait(lock,
+                         [this] { return stop_ || !full_buffers_.empty(); });
+    if (full_buffers_.empty()) {
+      return;
+    }
+    std::unique_ptr<Buffer> buffer = std::move(full_buffers_.front());
+    full_buffers_.pop_front();
+    writing_ = true;
+    lock.unlock();
+    size_t written =
+        std::fwrite(buffer->data(), sizeof(TraceRecord), buffer->size(), file_);
+    lock.lock();
+    num_records_ += written;
+    write_failed_ |= written != buffer->size();
+    buffer->clear();
+    free_buffers_.push_back(std::move(buffer));
+    writing_ = false;
+    if (full_buffers_.empty()) {
+      work_done_.notify_all();
+    }
+  }
+}
+
+}  // namespace epideux
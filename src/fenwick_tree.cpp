@@ -0,0 +1,192 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include "epideux/fenwick_tree.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+
+namespace epideux {
+
+///
+/// @class FenwickTree
+/// A binary indexed tree of non-negative weights.
+///
+/// The tree supports changing a weight and sampling an index proportional to
+/// the weights, both in O(log n). The locations use it to select the persons
+/// to infect by their susceptibility without scanning all occupants.
+///
+
+///
+/// Get the number of weights in the tree.
+///
+size_t FenwickTree::size() const { return values_.size(); }
+
+///
+/// Get the bytes reserved by the tree's two arrays.
+///
+size_t FenwickTree::capacityBytes() const {
+  return (values_.capacity() + tree_.capacity()) * sizeof(double);
+}
+
+///
+/// Make room for n weights, so appending up to n does not rebuild the tree.
+///
+void FenwickTree::reserve(size_t n) {
+  if (n <= capacity_) {
+    return;
+  }
+  size_t new_capacity = capacity_ == 0 ? 1 : capacity_;
+  while (new_capacity < n) {
+    new_capacity *= 2;
+  }
+  values_.reserve(new_capacity);
+  rebuild(new_capacity);
+}
+
+///
+/// Append a weight to the end of the tree.
+///
+/// The capacity is doubled when the tree is full, so appending is amortized
+/// constant time.
+///
+void FenwickTree::pushBack(double weight) {
+  if (values_.size() == capacity_) {
+    rebuild(capacity_ == 0 ? 1 : 2 * capacity_);
+  }
+  values_.push_back(0.0);
+  set(values_.size() - 1, weight);
+}
+
+///
+/// Set the weight at index i.
+///
+void FenwickTree::set(size_t i, double weight) {
+  add(i, weight - values_[i]);
+  values_[i] = weight;
+}
+
+///
+/// Get the weight at index i.
+///
+double FenwickTree::get(size_t i) const { return values_[i]; }
+
+///
+/// Get the sum of all the weights.
+///
+double FenwickTree::total() const { return total_; }
+
+///
+/// Find the index where the cumulative weight passes u.
+///
+/// Drawing u uniformly from [0, total()) samples an index proportional to the
+/// weights.
+///
+/// @param u A value in [0, total()).
+/// @returns The smallest index i for which the sum of the weights up to and
+/// including i is larger than u, or size() if all the weights are zero.
+///
+size_t FenwickTree::find(double u) const {
+  size_t pos = 0;
+  for (size_t step = capacity_; step > 0; step >>= 1) {
+    if ((pos + step <= capacity_) && (tree_[pos + step] <= u)) {
+      pos += step;
+      u -= tree_[pos];
+    }
+  }
+  // Rounding in the partial sums may carry u past the last positive weight,
+  // or leave a residue in total() after the weights are set to zero. Fall back
+  // to the last positive weight up to pos.
+  size_t i = std::min(pos + 1, values_.size());
+  while ((i > 0) && (values_[i - 1] <= 0.0)) {
+    --i;
+  }
+  return i > 0 ? i - 1 : values_.size();
+}
+
+///
+/// Write the tree in binary, including the partial sums.
+///
+/// The sums are kept as they are rather than recomputed, so a loaded tree
+/// samples exactly like the saved one.
+///
+void FenwickTree::save(std::ostream& out) const {
+  uint64_t num_values = values_.size();
+  uint64_t capacity = capacity_;
+  out.write(reinterpret_cast<const char*>(&num_values), sizeof(num_values));
+  out.write(reinterpret_cast<const char*>(&capacity), sizeof(capacity));
+  out.write(reinterpret_cast<const char*>(&total_), sizeof(total_));
+  out.write(reinterpret_cast<const char*>(values_.data()),
+            values_.size() * sizeof(double));
+  out.write(reinterpret_cast<const char*>(tree_.data()),
+            tree_.size() * sizeof(double));
+}
+
+///
+/// Read a tree written by save().
+///
+void FenwickTree::load(std::istream& in) {
+  uint64_t num_values = 0;
+  uint64_t capacity = 0;
+  in.read(reinterpret_cast<char*>(&num_values), sizeof(num_values));
+  in.read(reinterpret_cast<char*>(&capacity), sizeof(capacity));
+  if (!in || (num_values > capacity) || ((capacity & (capacity - 1)) != 0)) {
+    throw std::runtime_error("Corrupt Fenwick tree");
+  }
+  in.read(reinterpret_cast<char*>(&total_), sizeof(total_));
+  capacity_ = capacity;
+  values_.resize(num_values);
+  tree_.resize(capacity_ + 1);
+  in.read(reinterpret_cast<char*>(values_.data()),
+          values_.size() * sizeof(double));
+  in.read(reinterpret_cast<char*>(tree_.data()), tree_.size() * sizeof(double));
+  if (!in) {
+    throw std::runtime_error("Corrupt Fenwick tree");
+  }
+}
+
+void FenwickTree::add(size_t i, double delta) {
+  total_ += delta;
+  for (size_t j = i + 1; j <= capacity_; j += j & (~j + 1)) {
+    tree_[j] += delta;
+  }
+}
+
+///
+/// Rebuild the tree with a new capacity in linear time.
+///
+/// The capacity is kept a power of two, so find() can descend the tree by
+/// halving the step.
+///
+void FenwickTree::rebuild(size_t new_capacity) {
+  capacity_ = new_capacity;
+  tree_.assign(capacity_ + 1, 0.0);
+  total_ = 0.0;
+  for (size_t i = 1; i <= values_.size(); ++i) {
+    tree_[i] += values_[i - 1];
+    total_ += values_[i - 1];
+    size_t parent = i + (i & (~i + 1));
+    if (parent <= capacity_) {
+      tree_[parent] += tree_[i];
+    }
+  }
+}
+
+}  // namespace epideux
@@ -0,0 +1,184 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "epideux/epideux.h"
+#include "epideux/hardware_counters.h"
+#include "epideux/log.h"
+#include "epideux/profiler.h"
+#include "epideux/stats_page.h"
+
+namespace epideux {
+
+///
+/// Run the model with a fixed time-step.
+///
+/// This is an alternative to the event-by-event simulation in simulate(). For
+/// dense itineraries, where everybody moves several times per day, the event
+/// engine ends up calling Location::updateInfections for every single move.
+/// The fixed-step engine instead advances the whole model in steps of
+/// time_step:
+///
+///  1. All scheduled events (movements and reports) that are due are applied
+///     in bulk. The locations do not evaluate infections while doing so.
+///  2. Every person updates the infection state, and the occupancy and
+///     weighted infectious and susceptible sums of all locations are gathered
+///     into flat per-location arrays.
+///  3. The probability of infection is computed for all locations in a single
+///     loop over the flat arrays.
+///  4. A binomial number of susceptible occupants is infected at every
+///     location with a non-zero probability.
+///
+/// Movements are rounded to the step that follows them, so the time-step
+/// should be small compared to the durations in the itineraries. When the
+/// duration is not a whole number of steps, the last step is shortened to end
+/// with the run.
+///
+/// @param simulation_duration The period to simulate forward.
+/// @param time_step The length of each step, e.g., 15 minutes or an hour.
+///
+void Model::simulateFixedStep(time_duration simulation_duration,
+                              time_duration time_step) {
+  if (time_step <= time_duration::zero()) {
+    throw std::invalid_argument("The time step must be positive");
+  }
+  time_pt stop_sim_at = current_sim_time_ + simulation_duration;
+  prepareSchedule(stop_sim_at);
+  // A report sink may throw in the middle of the run.
+  RunningFlag running(simulation_running_);
+  RunningFlag fixed_step_running(fixed_step_running_);
+  if (stats_page_) {
+    publishStats(true);
+  }
+
+  EPIDEUX_LOG_DEBUG(logger_.get(),
+                    "Starting fixed-step simulation [simtime: {}]",
+                    LogTime{current_sim_time_});
+
+  // Flat per-location arrays. The probability computation only touches these.
+  size_t num_locations = locations_.size();
+  double step_seconds =
+      std::chrono::duration_cast<std::chrono::duration<double>>(time_step)
+          .count();
+  std::vector<Location*> locations(num_locations);
+  std::vector<double> beta_step(num_locations);
+  for (auto& l : locations_) {
+    locations[l.id()] = &l;
+    beta_step[l.id()] = l.betaPerSecond() * step_seconds;
+  }
+  std::vector<double> num_occupants(num_locations);
+  std::vector<uint32_t> num_susceptible(num_locations);
+  std::vector<uint32_t> num_infected(num_locations);
+  std::vector<double> infectious_weight(num_locations);
+  std::vector<double> mean_susceptibility(num_locations);
+  std::vector<double> prob_of_infection(num_locations);
+
+  for (time_pt t = current_sim_time_; t < stop_sim_at; t += time_step) {
+    EPIDEUX_PROFILE_ZONE("Model::simulateFixedStep");
+    // Apply movements and reports in bulk.
+    while ((schedule_head_ < schedule_.size()) &&
+           (schedule_[schedule_head_].scheduled_time <= t)) {
+      auto& schedule_entry = schedule_[schedule_head_];
+      current_sim_time_ = schedule_entry.scheduled_time;
+      dispatch(schedule_entry);
+      ++schedule_head_;
+    }
+    current_sim_time_ = t;
+    if (stats_page_ && stats_page_->due()) {
+      publishStats(true);
+    }
+    // The rest of the step is the sweep over the locations.
+    EPIDEUX_STATS_PHASE(*this, Transmission);
+    HardwarePhaseScope hardware_phase(hardware_counters_.get(),
+                                      StatsPhase::Transmission);
+
+    // Progress the disease. The locations keep their sums up to date.
+    for (auto& p : persons_) {
+      p.updateInfection();
+    }
+    for (size_t l = 0; l < num_locations; ++l) {
+      num_occupants[l] = locations[l]->getPersons().size();
+      infectious_weight[l] = locations[l]->infectiousWeight();
+      num_susceptible[l] = locations[l]->numSusceptible();
+      mean_susceptibility[l] =
+          num_susceptible[l] > 0
+              ? locations[l]->susceptibilityWeight() / num_susceptible[l]
+              : 0.0;
+    }
+
+    // Compute the probability of infection for all locations in one pass over
+    // the flat arrays. Empty locations have no infectious people, so the max()
+    // only guards the division.
+    double step_fraction =
+        std::min(1.0, std::chrono::duration<double>(stop_sim_at - t) /
+                          time_step);
+    for (size_t l = 0; l < num_locations; ++l) {
+      prob_of_infection[l] =
+          1.0 - std::exp(-step_fraction * beta_step[l] *
+                         infectious_weight[l] * mean_susceptibility[l] /
+                         std::max(num_occupants[l], 1.0));
+    }
+
+    // Sample the number to infect at all locations, then select the victims.
+    fillBinomial(random_buffer_, num_infected.data(), num_susceptible.data(),
+                 prob_of_infection.data(), num_locations);
+    EPIDEUX_STATS_ADD(*this, binomial_draws, num_locations);
+    for (size_t l = 0; l < num_locations; ++l) {
+      if (num_infected[l] > 0) {
+        locations[l]->infectWeighted(num_infected[l]);
+      }
+    }
+  }
+
+  // Apply the remaining events, including the stop event.
+  while ((schedule_head_ < schedule_.size()) &&
+         (schedule_[schedule_head_].scheduled_time <= stop_sim_at)) {
+    auto& schedule_entry = schedule_[schedule_head_];
+    current_sim_time_ = schedule_entry.scheduled_time;
+    dispatch(schedule_entry);
+    ++schedule_head_;
+  }
+  current_sim_time_ = stop_sim_at;
+
+  // Bring the timestamps of the locations up to date, so the event engine
+  // does not evaluate the same period again.
+  for (auto& l : locations_) {
+    l.updateInfections();
+  }
+
+  EPIDEUX_LOG_DEBUG(logger_.get(),
+                    "Stopping fixed-step simulation [simtime: {}]",
+                    LogTime{current_sim_time_});
+  if (stats_page_) {
+    publishStats(false);
+  }
+  flushReports();
+}
+
+///
+/// Whether the fixed-step engine is currently driving the model.
+///
+/// The locations use this to skip their own infection evaluation when people
+/// enter and leave.
+///
+bool Model::fixedStepRunning() const { return fixed_step_running_; }
+
+}  // namespace epideux
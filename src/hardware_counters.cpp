@@ -0,0 +1,199 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
+
+#include "epideux/hardware_counters.h"
+
+namespace epideux {
+
+namespace {
+
+#if defined(__linux__)
+struct EventConfig {
+  uint32_t type;
+  uint64_t config;
+};
+
+constexpr EventConfig kEventConfigs[kNumHardwareEvents] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+                             (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                             (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES}};
+
+int openEvent(const EventConfig& event_config, int group_fd) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = event_config.type;
+  attr.config = event_config.config;
+  attr.read_format = PERF_FORMAT_GROUP;
+  attr.disabled = group_fd == -1 ? 1 : 0;
+  // Only user space is counted, which unprivileged processes are allowed.
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+#endif
+
+}  // namespace
+
+///
+/// @class HardwareCounters
+/// Cycles, instructions, cache misses and branch misses per phase.
+///
+/// The counters are opened as one group, so they are measured over the same
+/// intervals. Counters the processor or the virtual machine does not provide
+/// are left out. If none can be opened, e.g., because perf_event_paranoid
+/// forbids it, the counters are unavailable and the model runs without them.
+///
+/// Reading the counters is a system call, so profiling slows down the
+/// simulation considerably; compare the counts, not the wall time.
+///
+
+HardwareCounters::HardwareCounters() {
+  for (size_t i = 0; i < kNumHardwareEvents; ++i) {
+    fds_[i] = -1;
+    positions_[i] = -1;
+  }
+#if defined(__linux__)
+  for (size_t i = 0; i < kNumHardwareEvents; ++i) {
+    int fd = openEvent(kEventConfigs[i], group_fd_);
+    if (fd < 0) {
+      if (error_.empty()) {
+        error_ = std::string("perf_event_open failed for ") +
+                 eventName(static_cast<HardwareEvent>(i)) + ": " +
+                 std::strerror(errno);
+      }
+      continue;
+    }
+    if (group_fd_ == -1) {
+      group_fd_ = fd;
+    }
+    fds_[i] = fd;
+    positions_[i] = num_open_++;
+  }
+  if (group_fd_ != -1) {
+    ioctl(group_fd_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(group_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+#else
+  error_ = "Hardware counters are only supported on Linux";
+#endif
+}
+
+HardwareCounters::~HardwareCounters() {
+#if defined(__linux__)
+  for (int fd : fds_) {
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+#endif
+}
+
+///
+/// Check whether any counter could be opened.
+///
+bool HardwareCounters::available() const { return num_open_ > 0; }
+
+bool HardwareCounters::available(HardwareEvent event) const {
+  return positions_[static_cast<size_t>(event)] >= 0;
+}
+
+///
+/// Get the reason the first counter that could not be opened failed.
+///
+const std::string& HardwareCounters::error() const { return error_; }
+
+///
+/// Read the current values of all counters. Counters that are not available
+/// read as zero.
+///
+bool HardwareCounters::read(HardwareCounts& counts) const {
+  counts.fill(0);
+  if (num_open_ == 0) {
+    return false;
+  }
+#if defined(__linux__)
+  uint64_t buffer[1 + kNumHardwareEvents];
+  ssize_t expected = (1 + num_open_) * sizeof(uint64_t);
+  if (::read(group_fd_, buffer, sizeof(buffer)) != expected) {
+    return false;
+  }
+  for (size_t i = 0; i < kNumHardwareEvents; ++i) {
+    if (positions_[i] >= 0) {
+      counts[i] = buffer[1 + positions_[i]];
+    }
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+///
+/// Attribute the counts between two reads to a phase.
+///
+void HardwareCounters::add(StatsPhase phase, const HardwareCounts& begin,
+                           const HardwareCounts& end) {
+  HardwareCounts& counts = phases_[static_cast<size_t>(phase)];
+  for (size_t i = 0; i < kNumHardwareEvents; ++i) {
+    counts[i] += end[i] - begin[i];
+  }
+}
+
+///
+/// Get the counts attributed to a phase. Nested phases, i.e., the location
+/// updates, are also counted in the phase they happen in.
+///
+const HardwareCounts& HardwareCounters::phase(StatsPhase phase) const {
+  return phases_[static_cast<size_t>(phase)];
+}
+
+void HardwareCounters::reset() { phases_ = {}; }
+
+const char* HardwareCounters::eventName(HardwareEvent event) {
+  switch (event) {
+    case HardwareEvent::Cycles:
+      return "cycles";
+    case HardwareEvent::Instructions:
+      return "instructions";
+    case HardwareEvent::L1dReadMisses:
+      return "l1d_read_misses";
+    case HardwareEvent::LlcMisses:
+      return "llc_misses";
+    case HardwareEvent::BranchMisses:
+      return "branch_misses";
+    default:
+      return "unknown";
+  }
+}
+
+}  // namespace epideux
@@ -20,6 +20,9 @@
 #include <iterator>
 
 #include "epideux/epideux.h"
+#include "epideux/hardware_counters.h"
+#include "epideux/profiler.h"
+#include "epideux/transmission_log.h"
 
 namespace epideux {
 
@@ -27,29 +30,40 @@ namespace epideux {
 /// Construct a Location.
 ///
 /// @param simulation_model The simulation model that drives the simulation.
-/// @param name A name for the location.
+/// @param id The index of the location in the model.
 /// @param beta The beta parameter from standard SEIR models in infections/day.
+/// @param name A name for the location.
 ///
-Location::Location(Model& simulation_model, double beta, std::string name)
-    : model_(simulation_model), name_(name), beta_per_sec_(beta / 86400) {}
+Location::Location(Model& simulation_model, uint32_t id, double beta,
+                   std::string name)
+    : model_(simulation_model),
+      id_(id),
+      name_(name),
+      persons_(&simulation_model.occupancyPool()),
+      beta_per_sec_(beta / 86400) {}
 
 ///
 /// Get a list of persons in the location.
 ///
 /// @returns A reference to the internal list of persons in the location.
 ///
-const std::list<Person*>& Location::getPersons() const { return persons_; }
+const std::pmr::list<Person*>& Location::getPersons() const { return persons_; }
 
 ///
 /// Evaluates any possible infections since last update.
 ///
-/// Using a binomial distribution, the method samples a number of people to
-/// become infected. When we have found the number of people to infect, we
-/// choose them by a uniform selection among all the persons at the location.
-/// The random sampled person may be infectious himself but we accept that.
-/// (Future considerations may prove us right or wrong).
+/// The location keeps the sum of the infectiousness of the infectious
+/// occupants and the susceptibility of the susceptible occupants up to date as
+/// people come and go, so the force of infection is available without
+/// counting. The occupants still update their own infection state, as the
+/// disease progresses lazily.
 ///
 void Location::updateInfections() {
+  EPIDEUX_PROFILE_ZONE("Location::updateInfections");
+  EPIDEUX_STATS_ADD(model_, update_infections_calls, 1);
+  EPIDEUX_STATS_PHASE(model_, LocationUpdate);
+  HardwarePhaseScope hardware_phase(model_.hardwareCounters(),
+                                    StatsPhase::LocationUpdate);
   // Update timestamp. Short-circuit if the time didn't progress since last
   // update.
   time_duration time_delta((model_.currentTime() - last_update_).count());
@@ -58,6 +72,12 @@ void Location::updateInfections() {
     return;
   }
 
+  // The fixed-step engine evaluates all locations at once, so only the
+  // timestamp is kept up to date here.
+  if (model_.fixedStepRunning()) {
+    return;
+  }
+
   // Check if we even have people here. Short-circuit if there are none.
   int num_persons_here = persons_.size();
   if (num_persons_here == 0) {
@@ -65,92 +85,308 @@ void Location::updateInfections() {
   }
 
   // Let everybody update their infection state.
+  EPIDEUX_STATS_ADD(model_, occupants_visited, num_persons_here);
   for (const auto& p : persons_) {
     p->updateInfection();
   }
 
-  // Count number of infectious people.
-  int num_infectious_persons =
-      std::count_if(persons_.begin(), persons_.end(), [](const auto& p) {
-        return p->infectionState() == InfectionCategory::Infectious;
-      });
+  // With exposure accumulation the occupants settle the exposure they have
+  // built up since entering, so people staying put get infected too.
+  if (model_.transmissionModel() == TransmissionModel::ExposureAccumulation) {
+    advancePressure();
+    for (const auto& p : persons_) {
+      settleExposure(*p);
+    }
+    return;
+  }
+
+  if ((num_infectious_ == 0) || (num_susceptible_ == 0)) {
+    return;
+  }
 
-  // Compute the probability of getting infected.
+  // Compute the probability of an average susceptible getting infected.
   auto time_step =
       std::chrono::duration_cast<std::chrono::seconds>(time_delta).count();
   double prob_of_infection =
-      1 - std::exp(-beta_per_sec_ * time_step * num_infectious_persons /
-                   num_persons_here);
-
-  // Sample a number to infect and select (and infect) them.
-  std::binomial_distribution<int> binom_dist(num_persons_here,
-                                             prob_of_infection);
-  int num_infected = binom_dist(model_.randomGenerator());
-  if (num_infected > 0) {
-    std::uniform_int_distribution<int> uni_dist(0, num_persons_here - 1);
-    auto& gen = model_.randomGenerator();
-    std::vector<size_t> infected_indexes(num_infected);
-    std::generate(infected_indexes.begin(), infected_indexes.end(),
-                  [&uni_dist, &gen](){ return uni_dist(gen); });
-    std::sort(infected_indexes.begin(), infected_indexes.end());
-    // turn indexes into increments as list iterators are not random access and
-    // need to be advanced forward.
-    for (int i = infected_indexes.size()-1; i > 0 ; --i) {
-      infected_indexes[i] -= infected_indexes[i-1];
+      1 - std::exp(-beta_per_sec_ * time_step * infectiousWeight() *
+                   susceptibilityWeight() /
+                   (num_persons_here * num_susceptible_));
+  infectSusceptibles(prob_of_infection);
+}
+
+///
+/// Infect a binomial number of the susceptible occupants.
+///
+/// Using a binomial distribution, the method samples a number of the
+/// susceptible people to become infected. The victims are then selected
+/// proportional to their susceptibility.
+///
+/// @param prob_of_infection The probability of an average susceptible
+/// occupant getting infected.
+///
+void Location::infectSusceptibles(double prob_of_infection) {
+  EPIDEUX_STATS_ADD(model_, binomial_draws, 1);
+  infectWeighted(
+      model_.randomBuffer().binomial(num_susceptible_, prob_of_infection));
+}
+
+///
+/// Infect a number of the susceptible occupants, selected proportional to
+/// their susceptibility.
+///
+void Location::infectWeighted(uint32_t num_infected) {
+  auto& buffer = model_.randomBuffer();
+  for (uint32_t i = 0; i < num_infected; ++i) {
+    double total_weight = susceptibility_tree_.total();
+    if (total_weight <= 0.0) {
+      break;
     }
-    auto persons_it = persons_.begin();
-    for (auto i : infected_indexes) {
-      std::advance(persons_it, i);
-      (*persons_it)->infect();
+    // The binomial draw counts the susceptibles with zero weight too, so the
+    // positive weights may run out before the draws do. The tree then only
+    // holds a rounding residue, and find() finds no slot.
+    size_t slot = susceptibility_tree_.find(buffer.uniform() * total_weight);
+    Person* victim =
+        slot < slot_persons_.size() ? slot_persons_[slot] : nullptr;
+    if ((victim == nullptr) || !isSusceptible(victim->infectionState())) {
+      break;
     }
+    // Infecting removes the victim's weight from the tree.
+    transmit(*victim);
   }
 }
 
-std::function<void()> Location::enter(Person& new_person) {
+std::pmr::list<Person*>::iterator Location::enter(Person& new_person) {
   // TODO: Should maybe evaluate whether person is allowed in.
-  updateInfections();
+  if (model_.transmissionModel() == TransmissionModel::ExposureAccumulation) {
+    advancePressure();
+    new_person.exposure_mark_ = pressure_integral_;
+  } else {
+    updateInfections();
+  }
   persons_.push_back(&new_person);
-  std::list<Person*>::iterator new_person_it = persons_.end();
+  std::pmr::list<Person*>::iterator new_person_it = persons_.end();
   new_person_it--;
-  return std::bind(&Location::leave, this, new_person_it);
+
+  // Give the person a slot in the sampling tree.
+  if (free_slots_.empty()) {
+    new_person.location_slot_ = slot_persons_.size();
+    slot_persons_.push_back(&new_person);
+    susceptibility_tree_.pushBack(0.0);
+    infectiousness_tree_.pushBack(0.0);
+  } else {
+    new_person.location_slot_ = free_slots_.back();
+    free_slots_.pop_back();
+    slot_persons_[new_person.location_slot_] = &new_person;
+  }
+  addContribution(new_person);
+
+  return new_person_it;
 }
 
-void Location::leave(std::list<Person*>::iterator& leaving_person_it) {
-  updateInfections();
+void Location::leave(std::pmr::list<Person*>::iterator leaving_person_it) {
+  Person& leaving_person = **leaving_person_it;
+  if (model_.transmissionModel() == TransmissionModel::ExposureAccumulation) {
+    leaving_person.updateInfection();
+    advancePressure();
+    settleExposure(leaving_person);
+  } else {
+    updateInfections();
+  }
+  removeContribution(leaving_person);
+  slot_persons_[leaving_person.location_slot_] = nullptr;
+  free_slots_.push_back(leaving_person.location_slot_);
   persons_.erase(leaving_person_it);
 }
 
 ///
-/// Go through all agents and record their infection state.
+/// Add an occupant's infection state and weights to the location's sums.
 ///
-SeirReport Location::collectSeir() {
-  updateInfections();
+void Location::addContribution(const Person& person) {
+  advancePressure();
+  markChanged();
+  reportCount(counts_, person.infection_state_)++;
+  if (isSusceptible(person.infection_state_)) {
+    num_susceptible_++;
+    susceptibility_tree_.set(person.location_slot_, person.susceptibility_);
+  }
+  if (isInfectious(person.infection_state_)) {
+    num_infectious_++;
+    infectiousness_tree_.set(person.location_slot_, person.infectiousness_);
+  }
+}
+
+///
+/// Remove an occupant's infection state and weights from the location's sums.
+///
+void Location::removeContribution(const Person& person) {
+  advancePressure();
+  markChanged();
+  reportCount(counts_, person.infection_state_)--;
+  if (isSusceptible(person.infection_state_)) {
+    num_susceptible_--;
+    susceptibility_tree_.set(person.location_slot_, 0.0);
+  }
+  if (isInfectious(person.infection_state_)) {
+    num_infectious_--;
+    infectiousness_tree_.set(person.location_slot_, 0.0);
+  }
+}
+
+///
+/// Get the accumulated infectious pressure, i.e., the integral of
+/// beta * I / N over time, with I being the summed infectiousness.
+///
+double Location::infectiousPressure() {
+  advancePressure();
+  return pressure_integral_;
+}
+
+///
+/// Bring the pressure integral up to the current time.
+///
+/// The integrand only changes when the counts change, so calling this before
+/// every change keeps the integral exact at a constant cost. The integral is
+/// only accumulated with TransmissionModel::ExposureAccumulation and not while
+/// the fixed-step engine runs, as it evaluates infections on its own.
+///
+void Location::advancePressure() {
+  time_pt now = model_.currentTime();
+  if ((model_.transmissionModel() == TransmissionModel::ExposureAccumulation) &&
+      !model_.fixedStepRunning() && !persons_.empty()) {
+    double time_step =
+        std::chrono::duration_cast<std::chrono::duration<double>>(
+            now - last_pressure_update_)
+            .count();
+    pressure_integral_ +=
+        beta_per_sec_ * time_step * infectiousWeight() / persons_.size();
+  }
+  last_pressure_update_ = now;
+}
+
+///
+/// Evaluate the exposure a person has built up since the last settlement.
+///
+/// The person is infected with probability 1 - exp(-s * dP), where s is the
+/// susceptibility and dP the pressure accumulated since the person's mark.
+///
+void Location::settleExposure(Person& person) {
+  double exposure = pressure_integral_ - person.exposure_mark_;
+  person.exposure_mark_ = pressure_integral_;
+  if (!isSusceptible(person.infectionState()) ||
+      (exposure <= 0.0)) {
+    return;
+  }
+  double prob_of_infection = 1 - std::exp(-person.susceptibility_ * exposure);
+  if (model_.randomBuffer().uniform() < prob_of_infection) {
+    transmit(person);
+  }
+}
 
-  SeirReport a_report;
-  for (auto& p : persons_) {
-    switch (p->infectionState()) {
-        case InfectionCategory::Susceptible:
-          a_report.susceptible++;
-          break;
-        case InfectionCategory::Exposed:
-          a_report.exposed++;
-          break;
-        case InfectionCategory::Infectious:
-          a_report.infectious++;
-          break;
-        case InfectionCategory::Recovered:
-          a_report.recovered++;
-          break;
+///
+/// Infect an occupant and record the transmission to the model's transmission
+/// log, if any.
+///
+/// The infector is sampled among the infectious occupants proportional to
+/// their infectiousness, as the kernel does not single out who infected whom.
+/// It is drawn before the victim is infected, as the victim is infectious at
+/// once in models without an exposed state.
+///
+/// With TransmissionModel::ExposureAccumulation the infector is sampled among
+/// the people present when the exposure is settled, which need not be the
+/// ones who built it up.
+///
+void Location::transmit(Person& victim) {
+  EPIDEUX_STATS_ADD(model_, infections, 1);
+  TransmissionLog* transmission_log = model_.transmissionLog();
+  if (transmission_log == nullptr) {
+    victim.infect();
+    return;
+  }
+  uint32_t infector = kNoInfector;
+  uint32_t num_infectious = num_infectious_;
+  double total_weight = infectiousWeight();
+  if (total_weight > 0.0) {
+    // The weight may be a rounding residue of infectious occupants with zero
+    // infectiousness, in which case nobody is attributed.
+    double u = model_.randomBuffer().uniform() * total_weight;
+    size_t slot = infectiousness_tree_.find(u);
+    if ((slot < slot_persons_.size()) && (slot_persons_[slot] != nullptr)) {
+      infector = slot_persons_[slot]->id();
     }
   }
+  victim.infect();
+  transmission_log->append(
+      {std::chrono::duration_cast<std::chrono::nanoseconds>(
+           model_.currentTime().time_since_epoch())
+           .count(),
+       victim.id(), id_, infector, num_infectious});
+}
+
+uint32_t Location::numSusceptible() const { return num_susceptible_; }
 
-  return a_report;
+///
+/// Get the summed infectiousness of the infectious occupants.
+///
+double Location::infectiousWeight() const {
+  // Guard against rounding when the last infectious person leaves.
+  return num_infectious_ > 0 ? std::max(infectiousness_tree_.total(), 0.0)
+                             : 0.0;
+}
+
+///
+/// Get the summed susceptibility of the susceptible occupants.
+///
+double Location::susceptibilityWeight() const {
+  return num_susceptible_ > 0 ? susceptibility_tree_.total() : 0.0;
 }
 
+///
+/// Get the number of occupants in each compartment.
+///
+SeirReport Location::collectSeir() {
+  updateInfections();
+
+  // The counts are kept up to date as people come, go and change state.
+  return counts_;
+}
+
+///
+/// Get the number of occupants in each compartment without updating the
+/// infections first.
+///
+const SeirReport& Location::counts() const { return counts_; }
+
+///
+/// Tell the model's location recorder the first time the counts change since
+/// the last report.
+///
+void Location::markChanged() {
+  if (!changed_ && model_.recordingLocations()) {
+    changed_ = true;
+    model_.locationChanged(*this);
+  }
+}
+
+///
+/// Reset the change flag. The model does this when the change is recorded.
+///
+void Location::clearChanged() { changed_ = false; }
+
+///
+/// Change the transmission rate of the location.
+///
+/// The pressure built up so far is accumulated at the old rate first, so the
+/// new rate only applies from now on.
+///
 void Location::setBeta(double new_beta) {
+  advancePressure();
   beta_per_sec_ = new_beta / 86400;
 }
 
+double Location::betaPerSecond() const { return beta_per_sec_; }
+
 std::string Location::name() { return name_; }
 
+uint32_t Location::id() const { return id_; }
+
 }  // namespace epideux
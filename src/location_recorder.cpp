@@ -0,0 +1,190 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <algorithm>
+
+#include "epideux/location_recorder.h"
+
+namespace epideux {
+
+namespace {
+
+constexpr size_t kNumStates = DiseaseModel::num_states;
+
+uint64_t zigzag(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+///
+/// Reads varints back from the chunks.
+///
+class ChunkReader {
+ public:
+  explicit ChunkReader(const std::vector<std::vector<uint8_t>>& chunks)
+      : chunks_(chunks) {}
+
+  uint64_t varint() {
+    uint64_t value = 0;
+    for (int shift = 0;; shift += 7) {
+      while (position_ == chunks_[chunk_].size()) {
+        ++chunk_;
+        position_ = 0;
+      }
+      uint8_t byte = chunks_[chunk_][position_++];
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+        return value;
+      }
+    }
+  }
+
+ private:
+  const std::vector<std::vector<uint8_t>>& chunks_;
+  size_t chunk_ = 0;
+  size_t position_ = 0;
+};
+
+}  // namespace
+
+///
+/// @class LocationRecorder
+/// Records the compartment counts of every location over time.
+///
+/// Attach the recorder with Model::setLocationRecorder. At every report the
+/// model hands it the locations whose counts have changed since the last
+/// report. Only the locations where the counts differ from the last recorded
+/// values are encoded, as the change of each count in zigzag varints. A tick
+/// is encoded as:
+///
+///     varint number of locations
+///     per location: varint id increment, then a zigzag varint per count
+///
+/// The encoded bytes go into chunks of a fixed size, so recording never
+/// moves what is already recorded. The occupancy of a location is the sum of
+/// its counts.
+///
+
+///
+/// Construct a recorder.
+///
+/// @param chunk_size The size of each chunk of encoded bytes.
+///
+LocationRecorder::LocationRecorder(size_t chunk_size)
+    : chunk_size_(chunk_size) {}
+
+///
+/// Record a tick.
+///
+/// @param tick_time The time of the report.
+/// @param changed_locations The locations that may have changed since the
+/// last tick. The vector is sorted by location id.
+///
+void LocationRecorder::record(time_pt tick_time,
+                              std::vector<Location*>& changed_locations) {
+  std::sort(changed_locations.begin(), changed_locations.end(),
+            [](const Location* a, const Location* b) {
+              return a->id() < b->id();
+            });
+
+  // Keep the locations that actually differ from the last recorded counts.
+  changed_.clear();
+  for (auto* l : changed_locations) {
+    size_t base = size_t(l->id()) * kNumStates;
+    if (base + kNumStates > last_counts_.size()) {
+      last_counts_.resize(base + kNumStates, 0);
+    }
+    const SeirReport& counts = l->counts();
+    for (size_t i = 0; i < kNumStates; ++i) {
+      if (reportCount(counts, i) != last_counts_[base + i]) {
+        changed_.emplace_back(l->id(), counts);
+        break;
+      }
+    }
+  }
+
+  tick_times_.push_back(tick_time);
+  putVarint(changed_.size());
+  uint32_t previous_id = 0;
+  for (auto& change : changed_) {
+    size_t base = size_t(change.first) * kNumStates;
+    putVarint(change.first - previous_id);
+    previous_id = change.first;
+    for (size_t i = 0; i < kNumStates; ++i) {
+      uint32_t count = reportCount(change.second, i);
+      putVarint(zigzag(int64_t(count) - int64_t(last_counts_[base + i])));
+      last_counts_[base + i] = count;
+    }
+  }
+}
+
+///
+/// Reconstruct the counts of a location at every recorded tick.
+///
+LocationSeries LocationRecorder::series(uint32_t location_id) const {
+  LocationSeries result;
+  result.reserve(tick_times_.size());
+  ChunkReader reader(chunks_);
+  uint64_t values[kNumStates] = {};
+  for (time_pt tick_time : tick_times_) {
+    uint64_t num_changed = reader.varint();
+    uint32_t id = 0;
+    for (uint64_t c = 0; c < num_changed; ++c) {
+      id += reader.varint();
+      for (size_t i = 0; i < kNumStates; ++i) {
+        int64_t delta = unzigzag(reader.varint());
+        if (id == location_id) {
+          values[i] += delta;
+        }
+      }
+    }
+    SeirReport counts;
+    for (size_t i = 0; i < kNumStates; ++i) {
+      counts.*DiseaseModel::report_fields[i] = values[i];
+    }
+    result.emplace_back(tick_time, counts);
+  }
+  return result;
+}
+
+size_t LocationRecorder::numTicks() const { return tick_times_.size(); }
+
+size_t LocationRecorder::encodedBytes() const {
+  size_t bytes = 0;
+  for (auto& chunk : chunks_) {
+    bytes += chunk.size();
+  }
+  return bytes;
+}
+
+void LocationRecorder::putVarint(uint64_t value) {
+  do {
+    if (chunks_.empty() || (chunks_.back().size() == chunk_size_)) {
+      chunks_.emplace_back();
+      chunks_.back().reserve(chunk_size_);
+    }
+    uint8_t byte = value & 0x7f;
+    value >>= 7;
+    chunks_.back().push_back(value ? (byte | 0x80) : byte);
+  } while (value);
+}
+
+}  // namespace epideux
@@ -0,0 +1,233 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+
+#include "epideux/mapped_storage.h"
+
+namespace epideux {
+
+namespace {
+
+// The file grows in steps of this size as the tables fill it.
+constexpr size_t kGrowth = size_t(64) << 20;
+
+}  // namespace
+
+///
+/// @class MappedStorage
+/// A memory resource for the tables that may outgrow the memory.
+///
+/// Mapped onto a file, the storage reserves the address space for its full
+/// capacity up front, so the tables never move, and grows the file as they
+/// fill it. The allocations are laid out back to back in the order they are
+/// made, i.e., each person followed by the itinerary added right after it, so
+/// building the population home by home keeps the people of a home together.
+/// Memory freed in the file is not reused.
+///
+/// Before it is mapped, the storage allocates from the heap. A reservation
+/// makes it hand out the following allocations back to back from one heap
+/// block instead, which is how a scenario is loaded in bulk.
+///
+
+MappedStorage::~MappedStorage() {
+  if (base_) {
+    munmap(base_, capacity_);
+    close(fd_);
+  }
+  for (const auto& block : blocks_) {
+    munmap(block.first, block.second);
+  }
+}
+
+///
+/// Move all future allocations into a file.
+///
+/// The file is only scratch space; it is removed again immediately, and the
+/// space is released when the storage is destroyed. Random access is
+/// advised, as the simulation visits the persons in the order of their
+/// events.
+///
+/// @param path The path of the file, on a disk with room for the tables.
+/// @param capacity The largest size the tables may grow to, in bytes.
+///
+void MappedStorage::map(const std::string& path, size_t capacity) {
+  if (base_) {
+    throw std::logic_error("The storage is already mapped");
+  }
+  int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+  if (fd < 0) {
+    throw std::runtime_error("Could not create storage file " + path);
+  }
+  unlink(path.c_str());
+  void* mapping =
+      mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (mapping == MAP_FAILED) {
+    close(fd);
+    throw std::runtime_error("Could not map storage file " + path);
+  }
+  base_ = static_cast<char*>(mapping);
+  capacity_ = capacity;
+  used_ = 0;
+  file_size_ = 0;
+  fd_ = fd;
+  advise(Advice::Random);
+}
+
+bool MappedStorage::mapped() const { return base_ != nullptr; }
+
+///
+/// Get the number of bytes allocated in the file.
+///
+size_t MappedStorage::used() const { return used_; }
+
+size_t MappedStorage::capacity() const { return capacity_; }
+
+///
+/// Tell the operating system how the tables are about to be accessed.
+///
+/// Use Sequential while building a population in bulk, Random (the default)
+/// while simulating, and DontNeed to drop the tables from memory after a run.
+///
+void MappedStorage::advise(Advice advice) {
+  if (!base_) {
+    return;
+  }
+  // The access pattern covers the whole reservation, also the part the file
+  // grows into later. Paging applies to the part in use.
+  size_t length = capacity_;
+  int native_advice = MADV_NORMAL;
+  switch (advice) {
+    case Advice::Normal:
+      native_advice = MADV_NORMAL;
+      break;
+    case Advice::Random:
+      native_advice = MADV_RANDOM;
+      break;
+    case Advice::Sequential:
+      native_advice = MADV_SEQUENTIAL;
+      break;
+    case Advice::WillNeed:
+      native_advice = MADV_WILLNEED;
+      length = file_size_;
+      break;
+    case Advice::DontNeed:
+      // Dirty pages of a shared mapping are written back, not discarded.
+      msync(base_, file_size_, MS_SYNC);
+      native_advice = MADV_DONTNEED;
+      length = file_size_;
+      break;
+  }
+  if (length > 0) {
+    madvise(base_, length, native_advice);
+  }
+}
+
+///
+/// Make room for allocations of a known total size.
+///
+/// Before the storage is mapped, the allocations are carved out of one block
+/// of the size, so loading a population takes a single allocation. The block
+/// is mapped with huge pages where the system allows it, which saves most of
+/// the page faults of touching the tables for the first time. Memory freed in
+/// the block is not reused, and the block is released with the storage. In
+/// the file, the file is grown to fit the allocations at once.
+///
+/// @param bytes The bytes about to be allocated, including padding.
+///
+void MappedStorage::reserve(size_t bytes) {
+  if (base_) {
+    size_t new_size = std::min(capacity_, used_ + bytes);
+    if ((new_size > file_size_) && (ftruncate(fd_, new_size) == 0)) {
+      file_size_ = new_size;
+    }
+    return;
+  }
+  if ((bytes == 0) ||
+      (!blocks_.empty() && (blocks_.back().second - block_used_ >= bytes))) {
+    return;
+  }
+  void* block = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (block == MAP_FAILED) {
+    // The allocations fall back to the heap one by one.
+    return;
+  }
+#if defined(MADV_HUGEPAGE)
+  madvise(block, bytes, MADV_HUGEPAGE);
+#endif
+  blocks_.emplace_back(static_cast<char*>(block), bytes);
+  block_used_ = 0;
+}
+
+bool MappedStorage::inBlocks(const char* p) const {
+  for (const auto& block : blocks_) {
+    if ((p >= block.first) && (p < block.first + block.second)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void* MappedStorage::do_allocate(size_t bytes, size_t alignment) {
+  if (!base_) {
+    if (!blocks_.empty()) {
+      auto& block = blocks_.back();
+      size_t offset = (block_used_ + alignment - 1) & ~(alignment - 1);
+      if ((offset <= block.second) && (bytes <= block.second - offset)) {
+        block_used_ = offset + bytes;
+        return block.first + offset;
+      }
+    }
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+  size_t offset = (used_ + alignment - 1) & ~(alignment - 1);
+  if ((offset > capacity_) || (bytes > capacity_ - offset)) {
+    throw std::bad_alloc();
+  }
+  if (offset + bytes > file_size_) {
+    size_t new_size = std::min(capacity_, offset + bytes + kGrowth);
+    if (ftruncate(fd_, new_size) != 0) {
+      throw std::bad_alloc();
+    }
+    file_size_ = new_size;
+  }
+  used_ = offset + bytes;
+  return base_ + offset;
+}
+
+void MappedStorage::do_deallocate(void* p, size_t bytes, size_t alignment) {
+  char* c = static_cast<char*>(p);
+  if ((base_ && (c >= base_) && (c < base_ + capacity_)) || inBlocks(c)) {
+    return;
+  }
+  std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+}
+
+bool MappedStorage::do_is_equal(
+    const std::pmr::memory_resource& other) const noexcept {
+  return this == &other;
+}
+
+}  // namespace epideux
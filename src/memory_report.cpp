@@ -0,0 +1,173 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <algorithm>
+#include <string>
+
+#include "epideux/epideux.h"
+#include "epideux/memory_report.h"
+#include "epideux/scenario_file.h"
+
+namespace epideux {
+
+namespace {
+
+///
+/// Get the bytes taken by a heap allocation, assuming a glibc-like malloc
+/// with a size word per chunk, two-word granularity and a four-word minimum.
+///
+size_t heapBlock(size_t bytes) {
+  if (bytes == 0) {
+    return 0;
+  }
+  constexpr size_t kWord = sizeof(size_t);
+  size_t chunk = (bytes + kWord + 2 * kWord - 1) & ~(2 * kWord - 1);
+  return std::max(chunk, 4 * kWord);
+}
+
+///
+/// Get the bytes taken by an allocation from the person storage. A mapped
+/// storage hands out the bytes back to back.
+///
+size_t storageBlock(size_t bytes, bool mapped) {
+  return mapped ? bytes : heapBlock(bytes);
+}
+
+size_t vectorBytes(size_t capacity, size_t element_size) {
+  return heapBlock(capacity * element_size);
+}
+
+///
+/// Get the capacity of a vector after n push_backs, as the capacity doubles.
+///
+size_t grownCapacity(size_t n) {
+  size_t capacity = n > 0 ? 1 : 0;
+  while (capacity < n) {
+    capacity *= 2;
+  }
+  return capacity;
+}
+
+}  // namespace
+
+///
+/// Get the bytes held by the parts of the model.
+///
+/// The sizes are computed from the sizes and capacities of the containers
+/// rather than measured. Persons loaded from a scenario file share one block,
+/// so they are overstated by the bookkeeping of separate blocks. The report
+/// walks all persons and locations, so it takes time linear in the size of
+/// the model; take it between runs rather than per event.
+///
+MemoryReport Model::memoryReport() const {
+  MemoryReport report;
+  bool mapped = person_storage_.mapped();
+  report.persons_mapped = mapped;
+  report.persons =
+      persons_.size() * storageBlock(listNodeSize<Person>(), mapped) +
+      vectorBytes(person_index_.capacity(), sizeof(Person*));
+  size_t entry_bytes = storageBlock(listNodeSize<ItineraryEntry>(), mapped);
+  for (const auto& p : persons_) {
+    report.itinerary += p.itinerary_.size() * entry_bytes;
+  }
+
+  report.locations =
+      locations_.size() * heapBlock(listNodeSize<Location>()) +
+      vectorBytes(location_index_.capacity(), sizeof(Location*)) +
+      vectorBytes(changed_locations_.capacity(), sizeof(Location*));
+  size_t short_name = std::string().capacity();
+  for (const auto& l : locations_) {
+    if (l.name_.capacity() > short_name) {
+      report.location_names += heapBlock(l.name_.capacity() + 1);
+    }
+    // The occupancy nodes are carved out of the model's pool.
+    report.occupancy += l.persons_.size() * listNodeSize<Person*>();
+    report.sampling += l.susceptibility_tree_.capacityBytes() +
+                       l.infectiousness_tree_.capacityBytes() +
+                       vectorBytes(l.slot_persons_.capacity(), sizeof(Person*)) +
+                       vectorBytes(l.free_slots_.capacity(), sizeof(uint32_t));
+  }
+
+  report.schedule =
+      vectorBytes(schedule_.capacity(), sizeof(ScheduleEntry));
+  report.reports = vectorBytes(daily_reports_.capacity(), sizeof(SeirReport));
+  return report;
+}
+
+///
+/// Estimate the peak memory of a model before building it.
+///
+/// The peak is when the schedule holds all the itinerary events and reports
+/// of a run. The sampling trees are the only part that depends on the
+/// movements; the estimate assumes that every person holds a slot at home and
+/// at most one other location, with the arrays three quarters full.
+///
+/// @param counts The size of the scenario, e.g., from countScenario().
+///
+MemoryReport Model::estimateMemory(const ScenarioCounts& counts) {
+  MemoryReport report;
+  report.persons = counts.num_persons * heapBlock(listNodeSize<Person>()) +
+                   vectorBytes(grownCapacity(counts.num_persons),
+                               sizeof(Person*));
+  report.itinerary =
+      counts.num_itinerary_entries * heapBlock(listNodeSize<ItineraryEntry>());
+
+  report.locations = counts.num_locations * heapBlock(listNodeSize<Location>()) +
+                     vectorBytes(grownCapacity(counts.num_locations),
+                                 sizeof(Location*));
+  if ((counts.num_locations > 0) &&
+      (counts.names_size / counts.num_locations > std::string().capacity())) {
+    report.location_names =
+        counts.num_locations *
+        heapBlock(counts.names_size / counts.num_locations + 1);
+  }
+  report.occupancy = counts.num_persons * listNodeSize<Person*>();
+  size_t slots = counts.num_persons +
+                 std::min(counts.num_persons, counts.num_itinerary_entries);
+  size_t slot_bytes = 2 * sizeof(double) + sizeof(Person*) + sizeof(uint32_t);
+  report.sampling = slots * slot_bytes * 4 / 3 +
+                    counts.num_locations * 4 * heapBlock(sizeof(double));
+
+  report.schedule = vectorBytes(
+      grownCapacity(2 * counts.num_itinerary_entries + counts.num_reports + 1),
+      sizeof(ScheduleEntry));
+  report.reports =
+      vectorBytes(grownCapacity(counts.num_reports), sizeof(SeirReport));
+  return report;
+}
+
+///
+/// Read the size of a scenario file without loading it.
+///
+/// @param path The scenario file.
+/// @param num_reports The number of reports to keep, e.g., the days to
+/// simulate.
+///
+ScenarioCounts countScenario(const std::string& path, size_t num_reports) {
+  ScenarioFile file(path);
+  const ScenarioHeader& header = file.header();
+  ScenarioCounts counts;
+  counts.num_persons = header.num_persons;
+  counts.num_locations = header.num_locations;
+  counts.num_itinerary_entries = header.num_itinerary_entries;
+  counts.names_size = header.names_size;
+  counts.num_reports = num_reports;
+  return counts;
+}
+
+}  // namespace epideux
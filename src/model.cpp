@@ -19,11 +19,32 @@
 #include <stdexcept>
 
 #include "epideux/epideux.h"
+#include "epideux/event_trace.h"
+#include "epideux/hardware_counters.h"
+#include "epideux/location_recorder.h"
+#include "epideux/log.h"
+#include "epideux/profiler.h"
+#include "epideux/report_sink.h"
+#include "epideux/stats_page.h"
 
 using namespace std::chrono_literals;
 
 namespace epideux {
 
+namespace {
+
+// The number of events between looking at the clock to see whether the stats
+// page is due.
+constexpr uint64_t kStatsPagePeriod = 1024;
+
+// Mixed into the seed of the generator handed out for the scenario.
+constexpr uint64_t kScenarioSeedMask = 0x5ce7a210e5eed000ULL;
+
+static_assert(DiseaseModel::num_states <= kStatsPageMaxStates,
+              "The stats page holds the counts of all the states");
+
+}  // namespace
+
 ///
 /// @class Model
 /// The Model class is the central object in the simulation.
@@ -36,14 +57,12 @@ namespace epideux {
 /// infection state. The scheduler uses a variable time-step AKA a 'lazy'
 /// approach. It keeps track of the next person to move and updates all the
 /// people around that person when he moves. This is opposed to updating
-/// everybody at a fixed rate, e.g., once per hour. An entry in the schedule is
-/// a std::pair with the time to update as the first member and a callback
-/// function as the second.
+/// everybody at a fixed rate, e.g., once per hour. An entry in the schedule
+/// holds the time to update, the kind of event, and the person and itinerary
+/// entry it concerns.
 ///
 
-Model::Model() : report_interval_(24h) {
-  logger_ = spdlog::basic_logger_mt("Model", "logs/epideux-log.txt");
-}
+Model::Model() : persons_(&person_storage_), report_interval_(24h) {}
 
 ///
 /// Run the model.
@@ -58,33 +77,110 @@ Model::Model() : report_interval_(24h) {
 /// @param simulation_duration The period to simulate forward.
 ///
 void Model::simulate(time_duration simulation_duration) {
-  // Generate reporting steps and put into schedule
   time_pt stop_sim_at = current_sim_time_ + simulation_duration;
-  for (time_pt t = current_sim_time_; t < stop_sim_at; t += report_interval_) {
-    schedule_.emplace_back(t, std::bind(&Model::collectSeir, this));
+  prepareSchedule(stop_sim_at);
+  // A report sink may throw in the middle of the run.
+  RunningFlag running(simulation_running_);
+  if (stats_page_) {
+    publishStats(true);
   }
-  // Insert simulation stop event.
-  schedule_.emplace_back(stop_sim_at, std::bind(&Model::stopSimulation, this));
-
-  // Sort the schedule so everything is executed in order.
-  std::sort(schedule_.begin(), schedule_.end());
-  simulation_running_ = true;
 
   // Step through schedule
-  logger_->debug("Starting simulation [simtime: {}]", getCurrentTimeString());
+  EPIDEUX_LOG_DEBUG(logger_.get(), "Starting simulation [simtime: {}]",
+                    LogTime{current_sim_time_});
 
-  while ((current_sim_time_ < stop_sim_at) && (schedule_.size() > 0)) {
-    auto& schedule_entry = schedule_.front();
+  while ((current_sim_time_ < stop_sim_at) &&
+         (schedule_head_ < schedule_.size())) {
+    EPIDEUX_PROFILE_ZONE("Model::simulate");
+    auto& schedule_entry = schedule_[schedule_head_];
     current_sim_time_ = schedule_entry.scheduled_time;
-    schedule_entry.callback();
-    schedule_.pop_front();
-    logger_->debug("Reported at [simtime: {}]", getCurrentTimeString());
+    dispatch(schedule_entry);
+    EPIDEUX_LOG_TRACE(logger_.get(), "Dispatched event {} [simtime: {}]",
+                      static_cast<int>(schedule_entry.event),
+                      LogTime{current_sim_time_});
+    ++schedule_head_;
   }
 
-  current_sim_time_ += simulation_duration;
+  // The stop event leaves the clock at the end of the run. Set it anyway, so
+  // both engines end a run in the same place.
+  current_sim_time_ = stop_sim_at;
 
-  logger_->debug("Stoping simulation [simtime: {}]", getCurrentTimeString());
-  simulation_running_ = false;
+  EPIDEUX_LOG_DEBUG(logger_.get(), "Stopping simulation [simtime: {}]",
+                    LogTime{current_sim_time_});
+  if (stats_page_) {
+    publishStats(false);
+  }
+  flushReports();
+}
+
+///
+/// Load the reporting and stop events into the schedule and sort it.
+///
+/// The events of earlier runs are dropped first. The schedule is a vector
+/// that is consumed from the front, so the space they leave is reused without
+/// allocating.
+///
+/// @param stop_sim_at The time at which the simulation run ends.
+///
+void Model::prepareSchedule(time_pt stop_sim_at) {
+  EPIDEUX_STATS_PHASE(*this, Schedule);
+  HardwarePhaseScope hardware_phase(hardware_counters_.get(),
+                                    StatsPhase::Schedule);
+  schedule_.erase(schedule_.begin(), schedule_.begin() + schedule_head_);
+  schedule_head_ = 0;
+  // Generate reporting steps and put into schedule
+  for (time_pt t = current_sim_time_; t < stop_sim_at; t += report_interval_) {
+    schedule_.push_back({t, ScheduledEvent::Report, nullptr, nullptr});
+  }
+  // Insert simulation stop event.
+  schedule_.push_back({stop_sim_at, ScheduledEvent::Stop, nullptr, nullptr});
+
+  // Sort the schedule so everything is executed in order.
+  std::sort(schedule_.begin(), schedule_.end());
+  EPIDEUX_STATS_MAX(*this, peak_schedule_size, schedule_.size());
+}
+
+///
+/// Carry out an event from the schedule.
+///
+void Model::dispatch(const ScheduleEntry& schedule_entry) {
+  EPIDEUX_STATS_ADD(*this,
+                    events[static_cast<size_t>(schedule_entry.event)], 1);
+  switch (schedule_entry.event) {
+    case ScheduledEvent::Report: {
+      EPIDEUX_STATS_PHASE(*this, Report);
+      HardwarePhaseScope hardware_phase(hardware_counters_.get(),
+                                        StatsPhase::Report);
+      collectSeir();
+      break;
+    }
+    case ScheduledEvent::Stop:
+      stopSimulation();
+      break;
+    case ScheduledEvent::BeginItineraryEntry: {
+      EPIDEUX_STATS_PHASE(*this, Movement);
+      HardwarePhaseScope hardware_phase(hardware_counters_.get(),
+                                        StatsPhase::Movement);
+      schedule_entry.person->beginItineraryEntry(
+          schedule_entry.itinerary_entry);
+      break;
+    }
+    case ScheduledEvent::EndItineraryEntry: {
+      EPIDEUX_STATS_PHASE(*this, Movement);
+      HardwarePhaseScope hardware_phase(hardware_counters_.get(),
+                                        StatsPhase::Movement);
+      schedule_entry.person->endItineraryEntry(schedule_entry.itinerary_entry);
+      break;
+    }
+    default:
+      break;
+  }
+  // Only look at the clock every so many events.
+  ++events_dispatched_;
+  if (stats_page_ && (events_dispatched_ % kStatsPagePeriod == 0) &&
+      stats_page_->due()) {
+    publishStats(true);
+  }
 }
 
 void Model::setStartDate(int year, int month, int day) {
@@ -100,35 +196,89 @@ void Model::setStartDate(int year, int month, int day) {
 
 time_pt Model::currentTime() { return current_sim_time_; }
 
-std::string Model::getCurrentTimeString() {
-  time_t t = std::chrono::system_clock::to_time_t(current_sim_time_);
-  char t_str[100];
-  std::strftime(t_str, sizeof(t_str), "%c", std::localtime(&t));
-  std::string time_string(t_str);
-  return time_string;
-}
-
 Location& Model::createLocation(double beta, std::string name) {
-  locations_.emplace_back(*this, beta, name);
+  locations_.emplace_back(*this, locations_.size(), beta, name);
+  location_index_.push_back(&locations_.back());
   return locations_.back();
 }
 
+///
+/// Create a person with an incubation time and a disease time.
+///
+/// The times are mapped onto the durations of the disease model. Models with
+/// more durations get their defaults, e.g., lifelong immunity.
+///
 Person& Model::createPerson(Location& home, time_duration incubation_time,
                             time_duration disease_time) {
-  persons_.emplace_back(*this, getNextId(), home, incubation_time,
-                        disease_time);
+  return createPerson(
+      home, DiseaseModel::makeDurations(incubation_time, disease_time));
+}
+
+///
+/// Create a person with all the durations of the disease model.
+///
+Person& Model::createPerson(Location& home, const DiseaseDurations& durations) {
+  persons_.emplace_back(*this, getNextId(), home, durations);
+  person_index_.push_back(&persons_.back());
   return persons_.back();
 }
 
+///
+/// Get a person by id.
+///
+/// The ids are handed out in the order the persons are created, so the
+/// lookup is a direct index.
+///
 Person& Model::getPerson(uint32_t i) {
-  auto it = std::find_if(persons_.begin(), persons_.end(),
-                         [i](const Person& p) { return p.id() == i; });
-  if (it == persons_.end()) {
+  if (i >= person_index_.size()) {
     throw std::out_of_range("Person not found");
   }
-  return *it;
+  return *person_index_[i];
+}
+
+///
+/// Get a location by id.
+///
+Location& Model::getLocation(uint32_t i) {
+  if (i >= location_index_.size()) {
+    throw std::out_of_range("Location not found");
+  }
+  return *location_index_[i];
+}
+
+///
+/// Keep the persons and their itineraries in a memory mapped file.
+///
+/// Use it for populations whose itineraries do not fit in memory. The
+/// operating system then pages the persons in and out as they are needed.
+/// Call it before creating any persons.
+///
+/// @param path The path of a scratch file, which is removed again.
+/// @param capacity The size to reserve for the persons and itineraries, in
+/// bytes.
+///
+void Model::mapPersonStorage(const std::string& path, size_t capacity) {
+  if (!persons_.empty()) {
+    throw std::logic_error("Map the person storage before creating persons");
+  }
+  person_storage_.map(path, capacity);
 }
 
+MappedStorage& Model::personStorage() { return person_storage_; }
+
+///
+/// Get the pool the locations allocate their occupancy lists from.
+///
+/// The pool keeps the nodes of people who left and hands them to the next
+/// people entering, so moving around does not touch the heap once the lists
+/// have grown to their working size.
+///
+std::pmr::memory_resource& Model::occupancyPool() { return occupancy_pool_; }
+
+size_t Model::numPersons() const { return persons_.size(); }
+
+size_t Model::numLocations() const { return locations_.size(); }
+
 ///
 /// Get the latest SEIR report
 ///
@@ -137,7 +287,101 @@ SeirReport Model::getReport() { return latest_report_; }
 ///
 /// Get all the daily SEIR reports since the simulation start
 ///
-SeirTimeline Model::getDailyReports() { return daily_reports_; }
+const SeirTimeline& Model::getDailyReports() const { return daily_reports_; }
+
+///
+/// Get a view of the daily SEIR reports kept in memory.
+///
+/// The view is invalidated by the next report.
+///
+ReportSpan Model::dailyReports() const {
+  return {daily_reports_.data(), daily_reports_.size()};
+}
+
+///
+/// Choose whether the model keeps every report in memory.
+///
+/// Long runs should turn this off and stream the reports to a sink instead.
+///
+void Model::setKeepDailyReports(bool keep_daily_reports) {
+  keep_daily_reports_ = keep_daily_reports;
+}
+
+///
+/// Add a sink that receives every report as it is produced.
+///
+void Model::addReportSink(std::shared_ptr<ReportSink> sink) {
+  report_sinks_.push_back(std::move(sink));
+}
+
+///
+/// Record the counts of the locations at every report.
+///
+/// Only the locations that change between reports are visited. Pass nullptr
+/// to stop recording.
+///
+void Model::setLocationRecorder(std::shared_ptr<LocationRecorder> recorder) {
+  location_recorder_ = std::move(recorder);
+  for (auto* l : changed_locations_) {
+    l->clearChanged();
+  }
+  changed_locations_.clear();
+  if (location_recorder_) {
+    // The recorder starts from empty locations, so all of them have changed.
+    for (auto& l : locations_) {
+      l.markChanged();
+    }
+  }
+}
+
+bool Model::recordingLocations() const {
+  return static_cast<bool>(location_recorder_);
+}
+
+///
+/// Called by a location the first time its counts change between reports.
+///
+void Model::locationChanged(Location& location) {
+  changed_locations_.push_back(&location);
+}
+
+///
+/// Flush all report sinks and the event trace. This is done at the end of
+/// every simulation run.
+///
+void Model::flushReports() {
+  for (auto& sink : report_sinks_) {
+    sink->flush();
+  }
+  if (event_trace_) {
+    event_trace_->flush();
+  }
+}
+
+///
+/// Record movement and infection events to a binary trace.
+///
+/// Pass nullptr to stop tracing.
+///
+void Model::setEventTrace(std::shared_ptr<EventTrace> event_trace) {
+  event_trace_ = std::move(event_trace);
+}
+
+EventTrace* Model::eventTrace() const { return event_trace_.get(); }
+
+///
+/// Capture who infected whom in a transmission log.
+///
+/// Pass nullptr to stop capturing.
+///
+void Model::setTransmissionLog(
+    std::shared_ptr<TransmissionLog> transmission_log) {
+  transmission_log_ = std::move(transmission_log);
+}
+
+TransmissionLog* Model::transmissionLog() const {
+  return transmission_log_.get();
+}
 
 ///
 /// Go through all agents and record their infection state.
@@ -148,32 +392,29 @@ SeirTimeline Model::getDailyReports() { return daily_reports_; }
 /// updated and recorded.
 ///
 void Model::collectSeir() {
+  EPIDEUX_PROFILE_ZONE("Model::collectSeir");
   for (auto& l : locations_) {
     l.updateInfections();
   }
 
-  latest_report_.susceptible = 0;
-  latest_report_.exposed = 0;
-  latest_report_.infectious = 0;
-  latest_report_.recovered = 0;
+  latest_report_ = SeirReport();
   for (auto& p : persons_) {
-    switch (p.infectionState()) {
-        case InfectionCategory::Susceptible:
-          latest_report_.susceptible++;
-          break;
-        case InfectionCategory::Exposed:
-          latest_report_.exposed++;
-          break;
-        case InfectionCategory::Infectious:
-          latest_report_.infectious++;
-          break;
-        case InfectionCategory::Recovered:
-          latest_report_.recovered++;
-          break;
-    }
+    reportCount(latest_report_, p.infectionState())++;
   }
 
-  daily_reports_.push_back(latest_report_);
+  if (keep_daily_reports_) {
+    daily_reports_.push_back(latest_report_);
+  }
+  for (auto& sink : report_sinks_) {
+    sink->write(current_sim_time_, latest_report_);
+  }
+  if (location_recorder_) {
+    location_recorder_->record(current_sim_time_, changed_locations_);
+    for (auto* l : changed_locations_) {
+      l->clearChanged();
+    }
+    changed_locations_.clear();
+  }
 }
 
 ///
@@ -181,13 +422,139 @@ void Model::collectSeir() {
 ///
 void Model::stopSimulation() { return; }
 
+///
+/// Choose how the locations transmit the disease.
+///
+/// With TransmissionModel::Binomial (the default) a location evaluates
+/// infections among all its occupants whenever somebody enters or leaves.
+/// With TransmissionModel::ExposureAccumulation a location only accumulates
+/// the infectious pressure, and each person evaluates the exposure on leaving,
+/// so moving costs the same regardless of how many people are present.
+///
+/// Change the transmission model before simulating.
+///
+void Model::setTransmissionModel(TransmissionModel transmission_model) {
+  transmission_model_ = transmission_model;
+}
+
+TransmissionModel Model::transmissionModel() const {
+  return transmission_model_;
+}
+
 ///
 /// Get the random generator from the model.
 ///
-/// Use this generator for all randomness, then a single seed can control and
-/// entire simulation run.
+/// Use this generator for the randomness of the scenario, then a single seed
+/// can control and entire simulation run. The engine itself draws from the
+/// random buffer. The type of both generators is chosen at build time with
+/// the EPIDEUX_RNG CMake option.
+///
+RandomGenerator& Model::randomGenerator() { return random_generator_; };
+
+///
+/// Get the buffer of precomputed randomness.
+///
+/// The hot loops in the locations draw their uniforms and binomials from this
+/// buffer, which is filled in batches.
+///
+RandomBuffer& Model::randomBuffer() { return random_buffer_; }
+
+///
+/// Seed all the randomness in the model.
+///
+void Model::seed(uint64_t seed_value) {
+  // The generators may be of the same type, so they get different seeds to
+  // not produce the same stream.
+  random_generator_.seed(seed_value ^ kScenarioSeedMask);
+  random_buffer_.seed(seed_value);
+}
+
+///
+/// Set the logger of the engine, or nullptr to not log at all, which is the
+/// default.
+///
+/// The engine logs the start and end of runs at debug level and every event
+/// at trace level. Only the levels up to the EPIDEUX_LOG_LEVEL CMake option
+/// are compiled in.
+///
+void Model::setLogger(std::shared_ptr<spdlog::logger> logger) {
+  logger_ = std::move(logger);
+}
+
+spdlog::logger* Model::logger() const { return logger_.get(); }
+
+///
+/// Get a snapshot of the performance counters.
+///
+/// The counters are only kept when the engine is built with the
+/// EPIDEUX_ENABLE_STATS CMake option; otherwise they are all zero. The
+/// snapshot may be taken from another thread while the model runs.
+///
+ModelStats Model::stats() const { return stats_counters_.snapshot(); }
+
+void Model::resetStats() { stats_counters_.reset(); }
+
+///
+/// Get the number of events the model has dispatched in all its runs.
+///
+/// The count is kept regardless of EPIDEUX_ENABLE_STATS. Read it between
+/// runs.
+///
+uint64_t Model::eventsDispatched() const { return events_dispatched_; }
+
+///
+/// Attribute hardware performance counters to the phases of the runs.
+///
+/// Create the counters on the thread that runs the simulation. Pass nullptr
+/// to stop counting.
+///
+void Model::setHardwareCounters(std::shared_ptr<HardwareCounters> counters) {
+  hardware_counters_ = std::move(counters);
+}
+
+HardwareCounters* Model::hardwareCounters() const {
+  return hardware_counters_.get();
+}
+
+///
+/// Publish the progress of the runs to a shared memory page, or nullptr to
+/// stop publishing.
+///
+/// The page is updated at the start and end of every run and at most once
+/// per interval of the page in between, without ever waiting for readers.
+///
+void Model::setStatsPage(std::shared_ptr<StatsPage> stats_page) {
+  stats_page_ = std::move(stats_page);
+  if (stats_page_) {
+    publishStats(simulation_running_);
+  }
+}
+
+StatsPage* Model::statsPage() const { return stats_page_.get(); }
+
+///
+/// Write the current statistics to the stats page.
+///
+void Model::publishStats(bool running) {
+  StatsPageData data = {};
+  data.sim_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      current_sim_time_.time_since_epoch())
+                      .count();
+  data.events = events_dispatched_;
+  data.schedule_depth = schedule_.size() - schedule_head_;
+  data.num_persons = persons_.size();
+  data.running = running;
+  data.num_states = DiseaseModel::num_states;
+  for (size_t s = 0; s < DiseaseModel::num_states; ++s) {
+    data.report[s] = reportCount(latest_report_, s);
+  }
+  stats_page_->publish(data);
+}
+
+///
+/// Get the live performance counters, for the agents to update.
 ///
-std::mt19937& Model::randomGenerator() { return random_generator_; };
+StatsCounters& Model::statsCounters() { return stats_counters_; }
 
 ///
 /// Get the next id for a new agent
@@ -195,16 +562,18 @@ std::mt19937& Model::randomGenerator() { return random_generator_; };
 uint32_t Model::getNextId() { return last_id_++; }
 
 ///
-/// Add a callback to the schedule
+/// Add an event to the schedule
 ///
 /// This is used but the agents to schedule the movements in their itineraries.
 ///
-void Model::addToSchedule(time_pt scheduled_time,
-                          std::function<void()> callback) {
+void Model::addToSchedule(time_pt scheduled_time, ScheduledEvent event,
+                          Person* person, ItineraryEntry* itinerary_entry) {
   if (simulation_running_) {
     // TODO:
   } else {
-    schedule_.push_back(ScheduleEntry(scheduled_time, callback));
+    schedule_.push_back({scheduled_time, event, person, itinerary_entry});
+    EPIDEUX_STATS_MAX(*this, peak_schedule_size,
+                      schedule_.size() - schedule_head_);
   }
 }
 
@@ -0,0 +1,59 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include "epideux/model_stats.h"
+
+namespace epideux {
+
+///
+/// Copy the counters into a plain snapshot.
+///
+ModelStats StatsCounters::snapshot() const {
+  ModelStats stats;
+  for (size_t i = 0; i < kNumScheduledEvents; ++i) {
+    stats.events[i] = events[i].load(std::memory_order_relaxed);
+  }
+  stats.update_infections_calls =
+      update_infections_calls.load(std::memory_order_relaxed);
+  stats.occupants_visited = occupants_visited.load(std::memory_order_relaxed);
+  stats.binomial_draws = binomial_draws.load(std::memory_order_relaxed);
+  stats.infections = infections.load(std::memory_order_relaxed);
+  stats.peak_schedule_size =
+      peak_schedule_size.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < kNumStatsPhases; ++i) {
+    stats.phase_seconds[i] =
+        phase_nanoseconds[i].load(std::memory_order_relaxed) * 1e-9;
+  }
+  return stats;
+}
+
+void StatsCounters::reset() {
+  for (auto& counter : events) {
+    counter.store(0, std::memory_order_relaxed);
+  }
+  update_infections_calls.store(0, std::memory_order_relaxed);
+  occupants_visited.store(0, std::memory_order_relaxed);
+  binomial_draws.store(0, std::memory_order_relaxed);
+  infections.store(0, std::memory_order_relaxed);
+  peak_schedule_size.store(0, std::memory_order_relaxed);
+  for (auto& counter : phase_nanoseconds) {
+    counter.store(0, std::memory_order_relaxed);
+  }
+}
+
+}  // namespace epideux
@@ -16,45 +16,61 @@
 // along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "epideux/epideux.h"
-#include "spdlog/spdlog.h"
+#include "epideux/event_trace.h"
+#include "epideux/log.h"
+#include "epideux/profiler.h"
 
 using namespace std::chrono_literals;
 
 namespace epideux {
 
 Person::Person(Model& simulation_model, uint32_t id, Location& home,
-               time_duration incubation_time, time_duration disease_time)
+               const DiseaseDurations& durations)
     : model_(simulation_model),
       id_(id),
       home_(home),
-      incubation_time_(incubation_time),
-      disease_time_(disease_time),
+      itinerary_(&simulation_model.personStorage()),
       infection_state_(InfectionCategory::Susceptible),
+      durations_(durations),
       active_itinerary_entry_(nullptr),
       current_location(&home_) {
-  leave_callback_ = home_.enter(*this);
+  location_it_ = home_.enter(*this);
 }
 
 void Person::addItineraryEntry(ItineraryEntry new_entry) {
   itinerary_.push_back(new_entry);
   auto* pushed_entry = &(itinerary_.back());
-  spdlog::debug("Person {}, adding entry at {}.", id_, (void*) pushed_entry);
-  model_.addToSchedule(
-      new_entry.startTime(),
-      std::bind(&Person::beginItineraryEntry, this, pushed_entry));
-  model_.addToSchedule(
-      new_entry.endTime(),
-      std::bind(&Person::endItineraryEntry, this, pushed_entry));
+  EPIDEUX_LOG_TRACE(model_.logger(), "Person {}, adding entry at {}.", id_,
+                    (void*) pushed_entry);
+  model_.addToSchedule(new_entry.startTime(),
+                       ScheduledEvent::BeginItineraryEntry, this, pushed_entry);
+  model_.addToSchedule(new_entry.endTime(), ScheduledEvent::EndItineraryEntry,
+                       this, pushed_entry);
+}
+
+///
+/// Sort the itinerary by start time.
+///
+/// The entries stay in place, so the schedule's references to them remain
+/// valid.
+///
+void Person::sortItinerary() {
+  itinerary_.sort([](const ItineraryEntry& a, const ItineraryEntry& b) {
+    return a.startTime() < b.startTime();
+  });
 }
 
 ///
 /// Moves the person from one location to another.
 ///
 void Person::moveToLocation(Location& location) {
-  spdlog::debug("Person {}, Moving to location {}.", id_, location.name());
-  leave_callback_();
+  EPIDEUX_PROFILE_ZONE("Person::moveToLocation");
+  EPIDEUX_LOG_TRACE(model_.logger(), "Person {}, Moving to location {}.", id_,
+                    location.id());
+  current_location->leave(location_it_);
   current_location = &location;
-  leave_callback_ = current_location->enter(*this);
+  location_it_ = current_location->enter(*this);
+  trace(TraceEventKind::Move, location);
 }
 
 ///
@@ -64,8 +80,10 @@ void Person::moveToLocation(Location& location) {
 /// itinerary. If another itinerary entry was active, this one takes precedence.
 ///
 void Person::beginItineraryEntry(ItineraryEntry* entry) {
-  spdlog::debug("Person {}, Beginning itinerary entry {}", id_, (void*) entry);
+  EPIDEUX_LOG_TRACE(model_.logger(), "Person {}, Beginning itinerary entry {}",
+                    id_, (void*) entry);
   active_itinerary_entry_ = entry;
+  trace(TraceEventKind::BeginItineraryEntry, entry->location());
   moveToLocation(entry->location());
 }
 
@@ -76,7 +94,10 @@ void Person::beginItineraryEntry(ItineraryEntry* entry) {
 /// is still valid. If so, he moves home as no other entry has taken precedence.
 ///
 void Person::endItineraryEntry(ItineraryEntry* entry) {
-  spdlog::debug("Person {}, Ending itinerary entry {} (active entry {})", id_, (void*) entry, (void*) active_itinerary_entry_);
+  EPIDEUX_LOG_TRACE(model_.logger(),
+                    "Person {}, Ending itinerary entry {} (active entry {})",
+                    id_, (void*) entry, (void*) active_itinerary_entry_);
+  trace(TraceEventKind::EndItineraryEntry, entry->location());
   // Compare the addresses to check if they are the same entry.
   if (entry == active_itinerary_entry_) {
     moveToLocation(home_);
@@ -87,25 +108,98 @@ void Person::endItineraryEntry(ItineraryEntry* entry) {
 }
 
 void Person::infect() {
-  if (infection_state_ == InfectionCategory::Susceptible) {
-    infection_state_ = InfectionCategory::Exposed;
-    infected_date_ = model_.currentTime();
+  if (isSusceptible(infection_state_)) {
+    state_entered_ = model_.currentTime();
+    setInfectionState(DiseaseModel::infected_state);
+    trace(TraceEventKind::Infection, *current_location);
   }
 }
 
+///
+/// Progress the disease according to the disease model's transition table.
+///
+/// The person may pass through several compartments if the update is late,
+/// or if some durations are zero.
+///
 void Person::updateInfection() {
-  if ((infection_state_ == InfectionCategory::Exposed) &&
-      (model_.currentTime() > (infected_date_ + incubation_time_))) {
-    infection_state_ = InfectionCategory::Infectious;
-  } else if ((infection_state_ == InfectionCategory::Infectious) &&
-             (model_.currentTime() >
-              (infected_date_ + incubation_time_ + disease_time_))) {
-    infection_state_ = InfectionCategory::Recovered;
+  for (;;) {
+    const auto& transition =
+        DiseaseModel::transitions[stateIndex(infection_state_)];
+    if (transition.duration == kNoTransition) {
+      return;
+    }
+    time_duration duration = durations_[transition.duration];
+    if ((duration == time_duration::max()) ||
+        !(model_.currentTime() > state_entered_ + duration)) {
+      return;
+    }
+    state_entered_ += duration;
+    setInfectionState(transition.next);
+    trace(TraceEventKind::StateChange, *current_location);
+  }
+}
+
+///
+/// Change the infection state and keep the current location's sums in sync.
+///
+void Person::setInfectionState(InfectionCategory new_state) {
+  current_location->removeContribution(*this);
+  infection_state_ = new_state;
+  current_location->addContribution(*this);
+}
+
+///
+/// Record an event to the model's event trace, if any.
+///
+void Person::trace(TraceEventKind kind, const Location& location) {
+  if (EventTrace* event_trace = model_.eventTrace()) {
+    event_trace->record(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            model_.currentTime().time_since_epoch())
+            .count(),
+        kind, id_, location.id(),
+        uint8_t(stateIndex(infection_state_)));
   }
 }
 
 InfectionCategory Person::infectionState() { return infection_state_; }
 
+///
+/// Set how infectious the person is relative to the average person.
+///
+/// Use it for, e.g., masks. The default is 1.
+///
+void Person::setInfectiousness(double infectiousness) {
+  current_location->removeContribution(*this);
+  infectiousness_ = infectiousness;
+  current_location->addContribution(*this);
+}
+
+///
+/// Set how susceptible the person is relative to the average person.
+///
+/// Use it for, e.g., age or vaccination. The default is 1.
+///
+void Person::setSusceptibility(double susceptibility) {
+  current_location->removeContribution(*this);
+  susceptibility_ = susceptibility;
+  current_location->addContribution(*this);
+}
+
+double Person::infectiousness() const { return infectiousness_; }
+
+double Person::susceptibility() const { return susceptibility_; }
+
 uint32_t Person::id() const { return id_; }
 
+Location& Person::currentLocation() const { return *current_location; }
+
+Location& Person::home() const { return home_; }
+
+const std::pmr::list<ItineraryEntry>& Person::itinerary() const {
+  return itinerary_;
+}
+
+const DiseaseDurations& Person::durations() const { return durations_; }
+
 }  // namespace epideux
\ No newline at end of file
@@ -0,0 +1,350 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "epideux/population_importer.h"
+
+using namespace std::chrono_literals;
+
+namespace epideux {
+
+namespace {
+
+// The files are read in chunks of this size. A row must fit in a chunk.
+constexpr size_t kChunkSize = 1 << 20;
+
+// Visits must start and end within this many seconds of the origin, so the
+// times fit the clock.
+constexpr int64_t kMaxVisitSeconds =
+    std::chrono::duration_cast<std::chrono::seconds>(time_duration::max())
+        .count() /
+    2;
+
+///
+/// Parse the digits of a field, refusing values above max_value.
+///
+bool parseDigits(const char* b, const char* e, uint64_t max_value,
+                 uint64_t& value) {
+  if (b == e) {
+    return false;
+  }
+  value = 0;
+  for (; b < e; ++b) {
+    if ((*b < '0') || (*b > '9')) {
+      return false;
+    }
+    uint64_t digit = *b - '0';
+    if (value > (max_value - digit) / 10) {
+      return false;
+    }
+    value = value * 10 + digit;
+  }
+  return true;
+}
+
+///
+/// Walks the fields of a single row without copying them.
+///
+class FieldCursor {
+ public:
+  FieldCursor(const char* begin, const char* end, char delimiter)
+      : p_(begin), end_(end), delimiter_(delimiter) {}
+
+  bool atEnd() const { return p_ >= end_; }
+
+  bool nextField(const char*& field_begin, const char*& field_end) {
+    if (p_ > end_) {
+      return false;
+    }
+    field_begin = p_;
+    while ((p_ < end_) && (*p_ != delimiter_)) {
+      ++p_;
+    }
+    field_end = p_;
+    ++p_;  // Skip the delimiter.
+    return true;
+  }
+
+  bool nextUnsigned(uint64_t& value) {
+    const char *b, *e;
+    return nextField(b, e) &&
+           parseDigits(b, e, std::numeric_limits<uint64_t>::max(), value);
+  }
+
+  bool nextSigned(int64_t& value) {
+    const char *b, *e;
+    if (!nextField(b, e)) {
+      return false;
+    }
+    bool negative = (b < e) && (*b == '-');
+    if (negative) {
+      ++b;
+    }
+    uint64_t magnitude;
+    if (!parseDigits(b, e, std::numeric_limits<int64_t>::max(), magnitude)) {
+      return false;
+    }
+    value = negative ? -static_cast<int64_t>(magnitude)
+                     : static_cast<int64_t>(magnitude);
+    return true;
+  }
+
+  bool nextDouble(double& value) {
+    const char *b, *e;
+    if (!nextField(b, e) || (b == e)) {
+      return false;
+    }
+    // The field is followed by a delimiter or a newline, so strtod stops in
+    // time without a terminated copy.
+    char* parsed_end;
+    value = std::strtod(b, &parsed_end);
+    return parsed_end == e;
+  }
+
+ private:
+  const char* p_;
+  const char* end_;
+  char delimiter_;
+};
+
+}  // namespace
+
+double ImportStats::rowsPerSecond() const {
+  return seconds > 0.0 ? rows / seconds : 0.0;
+}
+
+double ImportStats::megabytesPerSecond() const {
+  return seconds > 0.0 ? bytes / seconds / 1e6 : 0.0;
+}
+
+///
+/// @class PopulationImporter
+/// Streams a synthetic population from delimited text files into a model.
+///
+/// Three kinds of files are read, each with one record per row. A first row
+/// that does not start with a digit is taken as a header and skipped.
+///
+///  - Locations: id, beta in infections/day, and an optional name.
+///  - Persons: id, home location id, and optionally the incubation and
+///    disease times in hours.
+///  - Visits: person id, location id, and the start and end in seconds from
+///    the model's time when the importer was constructed.
+///
+/// Locations that are referenced but not listed are created with the default
+/// beta. The files are read in fixed-size chunks and parsed in place, so the
+/// memory used beyond the model itself is constant apart from the tables
+/// from ids to objects. The tables are hashed, so the ids need not be dense.
+/// Call finish() after importing the visits.
+///
+
+///
+/// Construct an importer.
+///
+/// @param simulation_model The model to import the population into.
+/// @param delimiter The field delimiter, ',' for CSV and '\t' for TSV.
+///
+PopulationImporter::PopulationImporter(Model& simulation_model, char delimiter)
+    : model_(simulation_model),
+      delimiter_(delimiter),
+      origin_(simulation_model.currentTime()),
+      default_incubation_time_(4 * 24h),
+      default_disease_time_(5 * 24h) {}
+
+///
+/// Set the beta of locations that are not listed in a locations file.
+///
+void PopulationImporter::setDefaultBeta(double beta) { default_beta_ = beta; }
+
+///
+/// Set the disease times of persons without times in the persons file.
+///
+void PopulationImporter::setDefaultDurations(time_duration incubation_time,
+                                             time_duration disease_time) {
+  default_incubation_time_ = incubation_time;
+  default_disease_time_ = disease_time;
+}
+
+ImportStats PopulationImporter::importLocations(const std::string& path) {
+  return readRows(path, [this](FieldCursor& fields) {
+    uint64_t id;
+    double beta;
+    const char *name_begin = nullptr, *name_end = nullptr;
+    if (!fields.nextUnsigned(id) || !fields.nextDouble(beta)) {
+      return false;
+    }
+    if (!fields.atEnd()) {
+      fields.nextField(name_begin, name_end);
+    }
+    auto it = locations_.find(id);
+    if (it != locations_.end()) {
+      it->second->setBeta(beta);
+      return true;
+    }
+    locations_[id] = &model_.createLocation(
+        beta, name_begin ? std::string(name_begin, name_end) : std::string());
+    return true;
+  });
+}
+
+ImportStats PopulationImporter::importPersons(const std::string& path) {
+  return readRows(path, [this](FieldCursor& fields) {
+    uint64_t id, home_id;
+    if (!fields.nextUnsigned(id) || !fields.nextUnsigned(home_id)) {
+      return false;
+    }
+    time_duration incubation_time = default_incubation_time_;
+    time_duration disease_time = default_disease_time_;
+    if (!fields.atEnd()) {
+      double incubation_hours, disease_hours;
+      if (!fields.nextDouble(incubation_hours) ||
+          !fields.nextDouble(disease_hours)) {
+        return false;
+      }
+      incubation_time = std::chrono::duration_cast<time_duration>(
+          std::chrono::duration<double, std::ratio<3600>>(incubation_hours));
+      disease_time = std::chrono::duration_cast<time_duration>(
+          std::chrono::duration<double, std::ratio<3600>>(disease_hours));
+    }
+    if (persons_.count(id) != 0) {
+      return false;
+    }
+    persons_[id] =
+        &model_.createPerson(location(home_id), incubation_time, disease_time);
+    return true;
+  });
+}
+
+ImportStats PopulationImporter::importVisits(const std::string& path) {
+  return readRows(path, [this](FieldCursor& fields) {
+    uint64_t person_id, location_id;
+    int64_t start, end;
+    if (!fields.nextUnsigned(person_id) || !fields.nextUnsigned(location_id) ||
+        !fields.nextSigned(start) || !fields.nextSigned(end)) {
+      return false;
+    }
+    auto person = persons_.find(person_id);
+    if ((person == persons_.end()) || (std::abs(start) > kMaxVisitSeconds) ||
+        (std::abs(end) > kMaxVisitSeconds)) {
+      return false;
+    }
+    person->second->addItineraryEntry(
+        ItineraryEntry(location(location_id), origin_ + start * 1s,
+                       origin_ + end * 1s));
+    return true;
+  });
+}
+
+///
+/// Sort the itinerary of every imported person once.
+///
+void PopulationImporter::finish() {
+  for (auto& [id, p] : persons_) {
+    p->sortItinerary();
+  }
+}
+
+///
+/// Look up a location by id, creating it with the default beta if needed.
+///
+Location& PopulationImporter::location(uint64_t id) {
+  Location*& location = locations_[id];
+  if (location == nullptr) {
+    location = &model_.createLocation(default_beta_);
+  }
+  return *location;
+}
+
+///
+/// Read a file chunk by chunk and hand each row to a handler.
+///
+/// Rows that straddle two chunks are moved to the front of the buffer before
+/// the next chunk is read in after them.
+///
+template <typename RowHandler>
+ImportStats PopulationImporter::readRows(const std::string& path,
+                                         RowHandler handle_row) {
+  auto start_time = std::chrono::steady_clock::now();
+  std::unique_ptr<FILE, int (*)(FILE*)> file(std::fopen(path.c_str(), "rb"),
+                                             &std::fclose);
+  if (!file) {
+    throw std::runtime_error("Could not open " + path);
+  }
+
+  ImportStats stats;
+  // One extra byte so the last row can be terminated if the file lacks a
+  // final newline.
+  std::vector<char> buffer(kChunkSize + 1);
+  size_t carried = 0;
+  uint64_t line_number = 0;
+  bool eof = false;
+  while (!eof) {
+    size_t read =
+        std::fread(buffer.data() + carried, 1, kChunkSize - carried, file.get());
+    stats.bytes += read;
+    size_t filled = carried + read;
+    eof = (read < kChunkSize - carried);
+    if (eof && (filled > 0) && (buffer[filled - 1] != '\n')) {
+      buffer[filled++] = '\n';
+    }
+
+    const char* p = buffer.data();
+    const char* end = buffer.data() + filled;
+    while (p < end) {
+      const char* eol = static_cast<const char*>(std::memchr(p, '\n', end - p));
+      if (eol == nullptr) {
+        break;
+      }
+      ++line_number;
+      const char* row_end = eol;
+      if ((row_end > p) && (*(row_end - 1) == '\r')) {
+        --row_end;
+      }
+      bool is_header = (line_number == 1) && (p < row_end) &&
+                       ((*p < '0') || (*p > '9'));
+      if ((row_end > p) && !is_header) {
+        FieldCursor fields(p, row_end, delimiter_);
+        if (!handle_row(fields)) {
+          throw std::runtime_error("Malformed row " +
+                                   std::to_string(line_number) + " in " +
+                                   path);
+        }
+        stats.rows++;
+      }
+      p = eol + 1;
+    }
+
+    carried = end - p;
+    if (!eof && (carried == kChunkSize)) {
+      throw std::runtime_error("Row longer than the chunk size in " + path);
+    }
+    std::memmove(buffer.data(), p, carried);
+  }
+
+  stats.seconds = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - start_time)
+                      .count();
+  return stats;
+}
+
+}  // namespace epideux
@@ -0,0 +1,223 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "epideux/profiler.h"
+
+namespace epideux {
+
+namespace {
+
+constexpr size_t kChunkRecords = 4096;
+
+// Records are appended by the owning thread and published through size, so
+// the trace can be exported while threads keep recording.
+struct Chunk {
+  ProfileRecord records[kChunkRecords];
+  std::atomic<size_t> size{0};
+  std::atomic<Chunk*> next{nullptr};
+};
+
+struct ThreadBuffer {
+  explicit ThreadBuffer(uint32_t id) : thread_id(id), head(new Chunk()) {
+    tail = head;
+  }
+  ~ThreadBuffer() {
+    freeAfter(head);
+    delete head;
+  }
+  void freeAfter(Chunk* chunk) {
+    Chunk* next = chunk->next.load(std::memory_order_acquire);
+    chunk->next.store(nullptr, std::memory_order_release);
+    while (next) {
+      Chunk* following = next->next.load(std::memory_order_acquire);
+      delete next;
+      next = following;
+    }
+  }
+  uint32_t thread_id;
+  Chunk* head;
+  Chunk* tail;
+};
+
+struct Registry {
+  std::mutex mutex;
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+  std::atomic<bool> running{false};
+  std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+};
+
+Registry& registry() {
+  static Registry instance;
+  return instance;
+}
+
+///
+/// Get the buffer of the calling thread, registering it on first use. The
+/// registry owns the buffers, so the records outlive the threads.
+///
+ThreadBuffer& threadBuffer() {
+  thread_local ThreadBuffer* buffer = nullptr;
+  if (!buffer) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.buffers.push_back(std::make_unique<ThreadBuffer>(r.buffers.size()));
+    buffer = r.buffers.back().get();
+  }
+  return *buffer;
+}
+
+///
+/// Write nanoseconds as microseconds with three decimals, without going
+/// through floating point.
+///
+void writeMicroseconds(std::ostream& out, uint64_t nanoseconds) {
+  uint64_t fraction = nanoseconds % 1000;
+  out << nanoseconds / 1000 << '.' << fraction / 100 << (fraction / 10) % 10
+      << fraction % 10;
+}
+
+}  // namespace
+
+///
+/// @class Profiler
+/// Lightweight zones around the hot functions, exported as a Chrome trace.
+///
+/// Compile the engine with EPIDEUX_ENABLE_PROFILER to get the zones of the
+/// engine, then start() the profiler around the part to look at and open the
+/// file from writeChromeTrace() in chrome://tracing or Perfetto. Every thread
+/// shows up as a track, which reveals load imbalance and stalls.
+///
+
+///
+/// Start recording zones.
+///
+void Profiler::start() {
+  registry().running.store(true, std::memory_order_relaxed);
+}
+
+void Profiler::stop() {
+  registry().running.store(false, std::memory_order_relaxed);
+}
+
+bool Profiler::running() {
+  return registry().running.load(std::memory_order_relaxed);
+}
+
+///
+/// Get the time in nanoseconds since the profiler was first used.
+///
+uint64_t Profiler::now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - registry().epoch)
+      .count();
+}
+
+///
+/// Append a zone to the calling thread's buffer.
+///
+void Profiler::record(const char* name, uint64_t begin, uint64_t end) {
+  ThreadBuffer& buffer = threadBuffer();
+  Chunk* chunk = buffer.tail;
+  size_t size = chunk->size.load(std::memory_order_relaxed);
+  if (size == kChunkRecords) {
+    Chunk* next = new Chunk();
+    chunk->next.store(next, std::memory_order_release);
+    buffer.tail = chunk = next;
+    size = 0;
+  }
+  chunk->records[size] = {name, begin, end};
+  chunk->size.store(size + 1, std::memory_order_release);
+}
+
+///
+/// Count the zones recorded by all threads.
+///
+size_t Profiler::numRecords() {
+  Registry& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  size_t count = 0;
+  for (auto& buffer : r.buffers) {
+    for (Chunk* c = buffer->head; c; c = c->next.load(std::memory_order_acquire)) {
+      count += c->size.load(std::memory_order_acquire);
+    }
+  }
+  return count;
+}
+
+///
+/// Drop all recorded zones. No thread may record while clearing.
+///
+void Profiler::clear() {
+  Registry& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  for (auto& buffer : r.buffers) {
+    buffer->freeAfter(buffer->head);
+    buffer->head->size.store(0, std::memory_order_release);
+    buffer->tail = buffer->head;
+  }
+}
+
+///
+/// Write the recorded zones in the Chrome trace event format.
+///
+/// The zones become complete ("X") events with microsecond timestamps, one
+/// track per thread.
+///
+void Profiler::writeChromeTrace(const std::string& path) {
+  std::ofstream out(path);
+  if (!out) {
+    throw std::runtime_error("Could not open trace file " + path);
+  }
+  Registry& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  bool first = true;
+  for (auto& buffer : r.buffers) {
+    out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\","
+        << "\"pid\":1,\"tid\":" << buffer->thread_id
+        << ",\"args\":{\"name\":\"thread " << buffer->thread_id << "\"}}";
+    first = false;
+    for (Chunk* c = buffer->head; c; c = c->next.load(std::memory_order_acquire)) {
+      size_t size = c->size.load(std::memory_order_acquire);
+      for (size_t i = 0; i < size; ++i) {
+        const ProfileRecord& record = c->records[i];
+        out << ",\n{\"name\":\"" << record.name
+            << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread_id
+            << ",\"ts\":";
+        writeMicroseconds(out, record.begin);
+        out << ",\"dur\":";
+        writeMicroseconds(out, record.end - record.begin);
+        out << '}';
+      }
+    }
+  }
+  out << "\n]}\n";
+  if (!out) {
+    throw std::runtime_error("Could not write trace file " + path);
+  }
+}
+
+}  // namespace epideux
@@ -0,0 +1,288 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <cmath>
+#include <istream>
+#include <ostream>
+
+#include "epideux/random.h"
+
+namespace epideux {
+
+namespace {
+
+///
+/// SplitMix64, used to expand a single seed into a full generator state.
+///
+uint64_t splitMix64(uint64_t& x) {
+  uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+// Below this mean the binomial is sampled by inversion.
+constexpr double kBinomialInversionLimit = 30.0;
+
+// The number of values fillUniform() generates at a time. A multiple of the
+// lanes of Xoshiro256ppX4, so no bits are dropped between the blocks.
+constexpr size_t kFillBlock = 256;
+
+}  // namespace
+
+Xoshiro256pp::Xoshiro256pp(uint64_t seed_value) { seed(seed_value); }
+
+void Xoshiro256pp::seed(uint64_t seed_value) {
+  for (auto& s : s_) {
+    s = splitMix64(seed_value);
+  }
+}
+
+///
+/// Advance the generator 2^128 steps.
+///
+/// Use it to make non-overlapping streams from the same seed.
+///
+void Xoshiro256pp::jump() {
+  static const uint64_t kJump[] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                   0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+  uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  for (uint64_t jump_word : kJump) {
+    for (int b = 0; b < 64; ++b) {
+      if (jump_word & (uint64_t(1) << b)) {
+        s0 ^= s_[0];
+        s1 ^= s_[1];
+        s2 ^= s_[2];
+        s3 ^= s_[3];
+      }
+      (*this)();
+    }
+  }
+  s_[0] = s0;
+  s_[1] = s1;
+  s_[2] = s2;
+  s_[3] = s3;
+}
+
+Pcg32::Pcg32(uint64_t seed_value) { seed(seed_value); }
+
+void Pcg32::seed(uint64_t seed_value) {
+  increment_ = (splitMix64(seed_value) << 1u) | 1u;
+  state_ = 0;
+  (*this)();
+  state_ += splitMix64(seed_value);
+  (*this)();
+}
+
+///
+/// Write the state of the generator as text, like the standard engines.
+///
+std::ostream& operator<<(std::ostream& os, const Xoshiro256pp& gen) {
+  return os << gen.s_[0] << ' ' << gen.s_[1] << ' ' << gen.s_[2] << ' '
+            << gen.s_[3];
+}
+
+std::istream& operator>>(std::istream& is, Xoshiro256pp& gen) {
+  return is >> gen.s_[0] >> gen.s_[1] >> gen.s_[2] >> gen.s_[3];
+}
+
+std::ostream& operator<<(std::ostream& os, const Pcg32& gen) {
+  return os << gen.state_ << ' ' << gen.increment_;
+}
+
+std::istream& operator>>(std::istream& is, Pcg32& gen) {
+  return is >> gen.state_ >> gen.increment_;
+}
+
+Xoshiro256ppX4::Xoshiro256ppX4(uint64_t seed_value) { seed(seed_value); }
+
+///
+/// Seed the four lanes from consecutive SplitMix64 outputs.
+///
+void Xoshiro256ppX4::seed(uint64_t seed_value) {
+  for (size_t lane = 0; lane < kLanes; ++lane) {
+    s0_[lane] = splitMix64(seed_value);
+    s1_[lane] = splitMix64(seed_value);
+    s2_[lane] = splitMix64(seed_value);
+    s3_[lane] = splitMix64(seed_value);
+  }
+}
+
+///
+/// Fill a buffer with random bits from the four lanes.
+///
+/// The lanes are independent, so the inner loop maps onto vector registers.
+///
+void Xoshiro256ppX4::fill(uint64_t* out, size_t n) {
+  size_t i = 0;
+  for (; i + kLanes <= n; i += kLanes) {
+    for (size_t lane = 0; lane < kLanes; ++lane) {
+      uint64_t sum = s0_[lane] + s3_[lane];
+      out[i + lane] = ((sum << 23) | (sum >> 41)) + s0_[lane];
+      uint64_t t = s1_[lane] << 17;
+      s2_[lane] ^= s0_[lane];
+      s3_[lane] ^= s1_[lane];
+      s1_[lane] ^= s2_[lane];
+      s0_[lane] ^= s3_[lane];
+      s2_[lane] ^= t;
+      s3_[lane] = (s3_[lane] << 45) | (s3_[lane] >> 19);
+    }
+  }
+  if (i < n) {
+    uint64_t tail[kLanes];
+    fill(tail, kLanes);
+    std::copy(tail, tail + (n - i), out + i);
+  }
+}
+
+std::ostream& operator<<(std::ostream& os, const Xoshiro256ppX4& gen) {
+  for (size_t lane = 0; lane < Xoshiro256ppX4::kLanes; ++lane) {
+    os << gen.s0_[lane] << ' ' << gen.s1_[lane] << ' ' << gen.s2_[lane] << ' '
+       << gen.s3_[lane] << ' ';
+  }
+  return os;
+}
+
+std::istream& operator>>(std::istream& is, Xoshiro256ppX4& gen) {
+  for (size_t lane = 0; lane < Xoshiro256ppX4::kLanes; ++lane) {
+    is >> gen.s0_[lane] >> gen.s1_[lane] >> gen.s2_[lane] >> gen.s3_[lane];
+  }
+  return is;
+}
+
+///
+/// Fill a buffer with uniform doubles in [0, 1).
+///
+/// The bits are generated into a small block on the stack and converted from
+/// there, as the doubles may not be written through a pointer to integers.
+///
+void fillUniform(Xoshiro256ppX4& gen, double* out, size_t n) {
+  uint64_t bits[kFillBlock];
+  for (size_t i = 0; i < n; i += kFillBlock) {
+    size_t block = std::min(kFillBlock, n - i);
+    gen.fill(bits, block);
+    for (size_t j = 0; j < block; ++j) {
+      out[i + j] = (bits[j] >> 11) * 0x1.0p-53;
+    }
+  }
+}
+
+///
+/// Fill a buffer with exponentially distributed doubles.
+///
+/// @param rate The rate parameter, i.e., one over the mean.
+///
+void fillExponential(Xoshiro256ppX4& gen, double* out, size_t n, double rate) {
+  fillUniform(gen, out, n);
+  for (size_t i = 0; i < n; ++i) {
+    out[i] = -std::log1p(-out[i]) / rate;
+  }
+}
+
+///
+/// Draw a binomial for each pair of n[i] and p[i].
+///
+void fillBinomial(RandomBuffer& buffer, uint32_t* out, const uint32_t* n,
+                  const double* p, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = buffer.binomial(n[i], p[i]);
+  }
+}
+
+///
+/// Construct a buffer of random bits.
+///
+/// @param seed_value The seed of the generator filling the buffer.
+/// @param size The number of 64 bit values generated at a time.
+///
+RandomBuffer::RandomBuffer(uint64_t seed_value, size_t size)
+    : generator_(seed_value), bits_(size), position_(size) {}
+
+void RandomBuffer::seed(uint64_t seed_value) {
+  generator_.seed(seed_value);
+  position_ = bits_.size();
+}
+
+///
+/// Write the generator, the unused bits and the binomial sampler, so a restored
+/// buffer continues the exact same sequence.
+///
+std::ostream& operator<<(std::ostream& os, const RandomBuffer& buffer) {
+  os << buffer.generator_ << ' ' << buffer.bits_.size() << ' '
+     << buffer.position_;
+  for (size_t i = buffer.position_; i < buffer.bits_.size(); ++i) {
+    os << ' ' << buffer.bits_[i];
+  }
+  return os << ' ' << buffer.binomial_dist_;
+}
+
+std::istream& operator>>(std::istream& is, RandomBuffer& buffer) {
+  size_t size = 0;
+  is >> buffer.generator_ >> size >> buffer.position_;
+  if (!is || (buffer.position_ > size)) {
+    is.setstate(std::ios::failbit);
+    return is;
+  }
+  buffer.bits_.resize(size);
+  for (size_t i = buffer.position_; i < size; ++i) {
+    is >> buffer.bits_[i];
+  }
+  return is >> buffer.binomial_dist_;
+}
+
+void RandomBuffer::refill() {
+  fillBits(generator_, bits_.data(), bits_.size());
+  position_ = 0;
+}
+
+///
+/// Sample a binomial distribution.
+///
+/// The common case in the simulation is a small mean, which is sampled by
+/// inversion from a single precomputed uniform. Larger means are handed to the
+/// standard library without constructing a new distribution.
+///
+uint32_t RandomBuffer::binomial(uint32_t n, double p) {
+  if ((n == 0) || (p <= 0.0)) {
+    return 0;
+  }
+  if (p >= 1.0) {
+    return n;
+  }
+  if (p > 0.5) {
+    return n - binomial(n, 1.0 - p);
+  }
+  if (n * p >= kBinomialInversionLimit) {
+    typedef std::binomial_distribution<uint32_t>::param_type param_type;
+    return binomial_dist_(*this, param_type(n, p));
+  }
+  double q = 1.0 - p;
+  double s = p / q;
+  double a = (n + 1) * s;
+  double r = std::pow(q, n);
+  double u = uniform();
+  uint32_t x = 0;
+  while ((u > r) && (x < n)) {
+    u -= r;
+    ++x;
+    r *= a / x - s;
+  }
+  return x;
+}
+
+}  // namespace epideux
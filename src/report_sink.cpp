@@ -0,0 +1,225 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include "epideux/report_sink.h"
+
+namespace epideux {
+
+namespace {
+
+constexpr char kReportMagic[8] = {'E', 'P', 'I', 'D', 'E', 'U', 'X', 'R'};
+constexpr uint32_t kReportVersion = 1;
+
+// The longest row: a time and a count per state with their separators.
+constexpr size_t kMaxCsvRowLength = 21 + 11 * DiseaseModel::num_states + 1;
+
+int64_t secondsSinceEpoch(time_pt t) {
+  return std::chrono::duration_cast<std::chrono::seconds>(t.time_since_epoch())
+      .count();
+}
+
+FILE* openOrThrow(const std::string& path) {
+  FILE* file = std::fopen(path.c_str(), "wb");
+  if (file == nullptr) {
+    throw std::runtime_error("Could not open report file " + path);
+  }
+  return file;
+}
+
+bool writeAll(const void* data, size_t size, size_t count, FILE* file) {
+  return std::fwrite(data, size, count, file) == count;
+}
+
+}  // namespace
+
+///
+/// Construct a CSV sink.
+///
+/// The first column is the report time in seconds since the epoch, followed
+/// by a column per compartment of the disease model. Failing writes throw a
+/// std::runtime_error from write() or flush().
+///
+/// @param path The path of the CSV file.
+/// @param buffer_size The number of bytes buffered between writes.
+///
+CsvReportSink::CsvReportSink(const std::string& path, size_t buffer_size)
+    : path_(path),
+      file_(openOrThrow(path)),
+      buffer_(std::max(buffer_size, kMaxCsvRowLength)) {
+  std::string header = "time";
+  for (auto name : DiseaseModel::state_names) {
+    header += ',';
+    header += name;
+  }
+  header += '\n';
+  if (!writeAll(header.data(), 1, header.size(), file_)) {
+    std::fclose(file_);
+    throw std::runtime_error("Could not write report file " + path_);
+  }
+}
+
+///
+/// Flush and close the file. The model flushes the sinks after every run, so
+/// errors are reported there; a failure here is ignored.
+///
+CsvReportSink::~CsvReportSink() {
+  try {
+    flush();
+  } catch (const std::runtime_error&) {
+  }
+  std::fclose(file_);
+}
+
+void CsvReportSink::write(time_pt report_time, const SeirReport& report) {
+  if (buffer_.size() - used_ < kMaxCsvRowLength) {
+    flush();
+  }
+  char* p = buffer_.data() + used_;
+  char* end = buffer_.data() + buffer_.size();
+  p = std::to_chars(p, end, secondsSinceEpoch(report_time)).ptr;
+  for (size_t i = 0; i < DiseaseModel::num_states; ++i) {
+    *p++ = ',';
+    p = std::to_chars(p, end, reportCount(report, i)).ptr;
+  }
+  *p++ = '\n';
+  used_ = p - buffer_.data();
+}
+
+void CsvReportSink::flush() {
+  bool written = writeAll(buffer_.data(), 1, used_, file_);
+  used_ = 0;
+  if (!written || (std::fflush(file_) != 0)) {
+    throw std::runtime_error("Could not write report file " + path_);
+  }
+}
+
+///
+/// Construct a binary sink.
+///
+/// The file starts with the magic "EPIDEUXR", a uint32 version and a uint32
+/// number of compartments. It is followed by blocks of reports, each with a
+/// uint32 number of reports n, n int64 report times in seconds since the
+/// epoch, and then n uint32 counts for each compartment in turn.
+///
+/// Failing writes throw a std::runtime_error from write() or flush().
+///
+/// @param path The path of the binary file.
+/// @param block_size The number of reports in a full block, at least one.
+///
+BinaryReportSink::BinaryReportSink(const std::string& path, size_t block_size)
+    : path_(path), file_(openOrThrow(path)), block_size_(block_size) {
+  if (block_size_ == 0) {
+    std::fclose(file_);
+    std::remove(path_.c_str());
+    throw std::invalid_argument("Report block size must be positive");
+  }
+  uint32_t version = kReportVersion;
+  uint32_t num_states = DiseaseModel::num_states;
+  if (!writeAll(kReportMagic, 1, sizeof(kReportMagic), file_) ||
+      !writeAll(&version, sizeof(version), 1, file_) ||
+      !writeAll(&num_states, sizeof(num_states), 1, file_)) {
+    std::fclose(file_);
+    throw std::runtime_error("Could not write report file " + path_);
+  }
+  times_.reserve(block_size_);
+  counts_.resize(block_size_ * DiseaseModel::num_states);
+}
+
+///
+/// Flush and close the file. Like for the CSV sink, a failure here is
+/// ignored.
+///
+BinaryReportSink::~BinaryReportSink() {
+  try {
+    flush();
+  } catch (const std::runtime_error&) {
+  }
+  std::fclose(file_);
+}
+
+void BinaryReportSink::write(time_pt report_time, const SeirReport& report) {
+  size_t row = times_.size();
+  times_.push_back(secondsSinceEpoch(report_time));
+  for (size_t i = 0; i < DiseaseModel::num_states; ++i) {
+    counts_[i * block_size_ + row] = reportCount(report, i);
+  }
+  if (times_.size() == block_size_) {
+    flush();
+  }
+}
+
+///
+/// Write the buffered reports as a block.
+///
+void BinaryReportSink::flush() {
+  // The block is dropped even if writing it fails, so the sink can go on.
+  bool written = true;
+  if (!times_.empty()) {
+    uint32_t n = times_.size();
+    written &= writeAll(&n, sizeof(n), 1, file_);
+    written &= writeAll(times_.data(), sizeof(int64_t), n, file_);
+    for (size_t i = 0; i < DiseaseModel::num_states; ++i) {
+      written &= writeAll(counts_.data() + i * block_size_, sizeof(uint32_t),
+                          n, file_);
+    }
+    times_.clear();
+  }
+  if (!written || (std::fflush(file_) != 0)) {
+    throw std::runtime_error("Could not write report file " + path_);
+  }
+}
+
+///
+/// Construct a ring buffer keeping the latest capacity reports.
+///
+RingBufferReportSink::RingBufferReportSink(size_t capacity)
+    : reports_(capacity), times_(capacity) {
+  if (capacity == 0) {
+    throw std::invalid_argument("Ring buffer capacity must be positive");
+  }
+}
+
+void RingBufferReportSink::write(time_pt report_time,
+                                 const SeirReport& report) {
+  reports_[next_] = report;
+  times_[next_] = report_time;
+  next_ = (next_ + 1) % reports_.size();
+  size_ = std::min(size_ + 1, reports_.size());
+}
+
+size_t RingBufferReportSink::size() const { return size_; }
+
+size_t RingBufferReportSink::capacity() const { return reports_.size(); }
+
+///
+/// Get the i'th report, counting from the oldest report kept.
+///
+const SeirReport& RingBufferReportSink::report(size_t i) const {
+  return reports_[(next_ + reports_.size() - size_ + i) % reports_.size()];
+}
+
+time_pt RingBufferReportSink::reportTime(size_t i) const {
+  return times_[(next_ + times_.size() - size_ + i) % times_.size()];
+}
+
+}  // namespace epideux
@@ -0,0 +1,253 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "epideux/epideux.h"
+#include "epideux/scenario_file.h"
+
+namespace epideux {
+
+namespace {
+
+int64_t toNanoseconds(time_duration duration) {
+  if (duration == time_duration::max()) {
+    return std::numeric_limits<int64_t>::max();
+  }
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(duration)
+      .count();
+}
+
+time_duration fromNanoseconds(int64_t nanoseconds) {
+  if (nanoseconds == std::numeric_limits<int64_t>::max()) {
+    return time_duration::max();
+  }
+  return std::chrono::duration_cast<time_duration>(
+      std::chrono::nanoseconds(nanoseconds));
+}
+
+time_pt timeFromNanoseconds(int64_t nanoseconds) {
+  return time_pt(fromNanoseconds(nanoseconds));
+}
+
+template <typename T>
+void writeArray(std::ofstream& out, const std::vector<T>& v) {
+  out.write(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(T));
+}
+
+}  // namespace
+
+///
+/// Write the model's scenario to a binary scenario file.
+///
+/// The scenario consists of the locations, the persons with their homes,
+/// disease durations and infection states, and their itineraries. The
+/// simulation state beyond that is not saved. Load the file again with
+/// loadScenario().
+///
+/// @param path The path of the scenario file.
+///
+void Model::saveScenario(const std::string& path) {
+  ScenarioHeader header = {};
+  std::copy(std::begin(kScenarioMagic), std::end(kScenarioMagic),
+            header.magic);
+  header.version = kScenarioVersion;
+  header.num_durations = DiseaseModel::NumDurations;
+  header.num_states = DiseaseModel::num_states;
+  header.start_time = toNanoseconds(current_sim_time_.time_since_epoch());
+
+  std::vector<ScenarioLocation> locations;
+  std::string names;
+  locations.reserve(locations_.size());
+  for (auto& l : locations_) {
+    std::string name = l.name();
+    locations.push_back({l.betaPerSecond() * 86400, names.size(),
+                         static_cast<uint32_t>(name.size()), 0});
+    names += name;
+  }
+
+  std::vector<ScenarioPerson> persons;
+  std::vector<ScenarioItineraryEntry> itinerary_entries;
+  persons.reserve(persons_.size());
+  for (auto& p : persons_) {
+    ScenarioPerson person = {};
+    person.home = p.home().id();
+    person.state = stateIndex(p.infection_state_);
+    person.itinerary_begin = itinerary_entries.size();
+    person.itinerary_count = p.itinerary().size();
+    person.state_entered = toNanoseconds(p.state_entered_.time_since_epoch());
+    for (size_t i = 0; i < DiseaseModel::NumDurations; ++i) {
+      person.durations[i] = toNanoseconds(p.durations()[i]);
+    }
+    persons.push_back(person);
+    for (auto& e : p.itinerary()) {
+      itinerary_entries.push_back(
+          {e.location().id(), 0,
+           toNanoseconds(e.startTime().time_since_epoch()),
+           toNanoseconds(e.endTime().time_since_epoch())});
+    }
+    std::sort(itinerary_entries.begin() + person.itinerary_begin,
+              itinerary_entries.end(),
+              [](const ScenarioItineraryEntry& a,
+                 const ScenarioItineraryEntry& b) { return a.start < b.start; });
+  }
+
+  header.num_locations = locations.size();
+  header.num_persons = persons.size();
+  header.num_itinerary_entries = itinerary_entries.size();
+  header.names_size = names.size();
+  header.locations_offset = sizeof(ScenarioHeader);
+  header.persons_offset =
+      header.locations_offset + locations.size() * sizeof(ScenarioLocation);
+  header.itinerary_offset =
+      header.persons_offset + persons.size() * sizeof(ScenarioPerson);
+  header.names_offset =
+      header.itinerary_offset +
+      itinerary_entries.size() * sizeof(ScenarioItineraryEntry);
+
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    throw std::runtime_error("Could not open scenario file " + path);
+  }
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  writeArray(out, locations);
+  writeArray(out, persons);
+  writeArray(out, itinerary_entries);
+  out.write(names.data(), names.size());
+  if (!out) {
+    throw std::runtime_error("Could not write scenario file " + path);
+  }
+}
+
+///
+/// Add the scenario in a binary scenario file to the model.
+///
+/// The file is memory mapped and the model is built directly from the flat
+/// arrays in it. The whole file is checked before the model is changed, so a
+/// corrupt file leaves the model as it was. If the model is empty, the start
+/// time is taken from the file.
+///
+/// The sizes in the header are known up front, so the indices, the schedule
+/// and the person storage are reserved once, and the persons and their
+/// itineraries are laid out back to back in a single block. The locations'
+/// sampling tables are sized for their residents.
+///
+/// @param path The path of the scenario file.
+///
+void Model::loadScenario(const std::string& path) {
+  ScenarioFile file(path);
+  const ScenarioHeader& header = file.header();
+  if ((header.num_durations != DiseaseModel::NumDurations) ||
+      (header.num_states != DiseaseModel::num_states)) {
+    throw std::runtime_error(
+        "Scenario file was written for another disease model");
+  }
+  if (header.num_persons > std::numeric_limits<uint32_t>::max() - last_id_) {
+    throw std::runtime_error("Too many persons in scenario file");
+  }
+
+  const ScenarioLocation* locations = file.locations();
+  const ScenarioPerson* persons = file.persons();
+  const ScenarioItineraryEntry* itinerary_entries = file.itineraryEntries();
+  const char* names = file.names();
+  for (uint64_t i = 0; i < header.num_locations; ++i) {
+    const ScenarioLocation& l = locations[i];
+    if ((l.name_offset > header.names_size) ||
+        (l.name_length > header.names_size - l.name_offset)) {
+      throw std::runtime_error("Corrupt scenario file");
+    }
+  }
+  std::vector<uint32_t> residents(header.num_locations, 0);
+  for (uint64_t i = 0; i < header.num_persons; ++i) {
+    const ScenarioPerson& p = persons[i];
+    if ((p.home >= header.num_locations) ||
+        (p.state >= DiseaseModel::num_states) ||
+        (p.itinerary_begin > header.num_itinerary_entries) ||
+        (p.itinerary_count >
+         header.num_itinerary_entries - p.itinerary_begin)) {
+      throw std::runtime_error("Corrupt scenario file");
+    }
+    residents[p.home]++;
+  }
+  for (uint64_t e = 0; e < header.num_itinerary_entries; ++e) {
+    if (itinerary_entries[e].location >= header.num_locations) {
+      throw std::runtime_error("Corrupt scenario file");
+    }
+  }
+
+  if (locations_.empty() && persons_.empty()) {
+    current_sim_time_ = timeFromNanoseconds(header.start_time);
+  }
+  size_t first_location = location_index_.size();
+  location_index_.reserve(first_location + header.num_locations);
+  person_index_.reserve(person_index_.size() + header.num_persons);
+  schedule_.reserve(schedule_.size() + 2 * header.num_itinerary_entries);
+  person_storage_.reserve(
+      header.num_persons * listNodeSize<Person>() +
+      header.num_itinerary_entries * listNodeSize<ItineraryEntry>());
+
+  for (uint64_t i = 0; i < header.num_locations; ++i) {
+    const ScenarioLocation& l = locations[i];
+    Location& location = createLocation(
+        l.beta, std::string(names + l.name_offset, l.name_length));
+    location.slot_persons_.reserve(residents[i]);
+    location.susceptibility_tree_.reserve(residents[i]);
+    location.infectiousness_tree_.reserve(residents[i]);
+  }
+
+  // The person storage is filled front to back.
+  person_storage_.advise(MappedStorage::Advice::Sequential);
+  for (uint64_t i = 0; i < header.num_persons; ++i) {
+    const ScenarioPerson& p = persons[i];
+    DiseaseDurations durations;
+    for (size_t d = 0; d < DiseaseModel::NumDurations; ++d) {
+      durations[d] = fromNanoseconds(p.durations[d]);
+    }
+    persons_.emplace_back(*this, getNextId(),
+                          *location_index_[first_location + p.home],
+                          durations);
+    Person& person = persons_.back();
+    person_index_.push_back(&person);
+    for (uint64_t e = p.itinerary_begin;
+         e < p.itinerary_begin + p.itinerary_count; ++e) {
+      const ScenarioItineraryEntry& entry = itinerary_entries[e];
+      time_pt start = timeFromNanoseconds(entry.start);
+      time_pt end = timeFromNanoseconds(entry.end);
+      person.itinerary_.emplace_back(
+          *location_index_[first_location + entry.location], start, end);
+      ItineraryEntry* loaded_entry = &person.itinerary_.back();
+      schedule_.push_back(
+          {start, ScheduledEvent::BeginItineraryEntry, &person, loaded_entry});
+      schedule_.push_back(
+          {end, ScheduledEvent::EndItineraryEntry, &person, loaded_entry});
+    }
+    person.state_entered_ = timeFromNanoseconds(p.state_entered);
+    auto state = static_cast<InfectionCategory>(p.state);
+    if (state != person.infection_state_) {
+      person.setInfectionState(state);
+    }
+  }
+  person_storage_.advise(MappedStorage::Advice::Random);
+  EPIDEUX_STATS_MAX(*this, peak_schedule_size,
+                    schedule_.size() - schedule_head_);
+}
+
+}  // namespace epideux
@@ -0,0 +1,123 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <stdexcept>
+
+#include "epideux/scenario_file.h"
+
+namespace epideux {
+
+///
+/// @class ScenarioFile
+/// A read-only memory mapping of a binary scenario file.
+///
+/// The mapping is shared, so processes running replicates of the same
+/// scenario share a single copy in the page cache. Nothing is parsed; the
+/// arrays are used in place.
+///
+
+///
+/// Map a scenario file and validate its header.
+///
+/// @param path The path of the scenario file.
+///
+ScenarioFile::ScenarioFile(const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Could not open scenario file " + path);
+  }
+  struct stat file_stat;
+  if ((fstat(fd, &file_stat) != 0) ||
+      (static_cast<size_t>(file_stat.st_size) < sizeof(ScenarioHeader))) {
+    close(fd);
+    throw std::runtime_error("Scenario file too small " + path);
+  }
+  size_ = file_stat.st_size;
+  void* mapping = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    throw std::runtime_error("Could not map scenario file " + path);
+  }
+  data_ = static_cast<const char*>(mapping);
+  // The arrays are read front to back while building the model.
+  madvise(mapping, size_, MADV_SEQUENTIAL);
+
+  const ScenarioHeader& h = header();
+  if (std::memcmp(h.magic, kScenarioMagic, sizeof(kScenarioMagic)) != 0) {
+    munmap(mapping, size_);
+    throw std::runtime_error("Not a scenario file " + path);
+  }
+  if (h.version != kScenarioVersion) {
+    munmap(mapping, size_);
+    throw std::runtime_error("Unsupported scenario file version in " + path);
+  }
+  try {
+    array<ScenarioLocation>(h.locations_offset, h.num_locations);
+    array<ScenarioPerson>(h.persons_offset, h.num_persons);
+    array<ScenarioItineraryEntry>(h.itinerary_offset, h.num_itinerary_entries);
+    array<char>(h.names_offset, h.names_size);
+  } catch (...) {
+    munmap(mapping, size_);
+    throw;
+  }
+}
+
+ScenarioFile::~ScenarioFile() {
+  munmap(const_cast<char*>(data_), size_);
+}
+
+const ScenarioHeader& ScenarioFile::header() const {
+  return *reinterpret_cast<const ScenarioHeader*>(data_);
+}
+
+const ScenarioLocation* ScenarioFile::locations() const {
+  return array<ScenarioLocation>(header().locations_offset,
+                                 header().num_locations);
+}
+
+const ScenarioPerson* ScenarioFile::persons() const {
+  return array<ScenarioPerson>(header().persons_offset, header().num_persons);
+}
+
+const ScenarioItineraryEntry* ScenarioFile::itineraryEntries() const {
+  return array<ScenarioItineraryEntry>(header().itinerary_offset,
+                                       header().num_itinerary_entries);
+}
+
+const char* ScenarioFile::names() const {
+  return array<char>(header().names_offset, header().names_size);
+}
+
+///
+/// Get a typed pointer into the mapping, checking that the array fits.
+///
+template <typename T>
+const T* ScenarioFile::array(uint64_t offset, uint64_t count) const {
+  if ((offset > size_) || (count > (size_ - offset) / sizeof(T)) ||
+      (offset % alignof(T) != 0)) {
+    throw std::runtime_error("Corrupt scenario file");
+  }
+  return reinterpret_cast<const T*>(data_ + offset);
+}
+
+}  // namespace epideux
@@ -0,0 +1,209 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include "epideux/stats_page.h"
+
+namespace epideux {
+
+namespace {
+
+std::string segmentName(const std::string& name) {
+  return (!name.empty() && (name[0] == '/')) ? name : "/" + name;
+}
+
+///
+/// Get the resident memory of the process from /proc/self/statm, without
+/// allocating. Returns 0 where it is not available.
+///
+uint64_t residentBytes() {
+  int fd = open("/proc/self/statm", O_RDONLY);
+  if (fd < 0) {
+    return 0;
+  }
+  char buffer[128];
+  ssize_t length = read(fd, buffer, sizeof(buffer) - 1);
+  close(fd);
+  if (length <= 0) {
+    return 0;
+  }
+  buffer[length] = '\0';
+  char* end;
+  std::strtoull(buffer, &end, 10);
+  uint64_t pages = std::strtoull(end, nullptr, 10);
+  return pages * sysconf(_SC_PAGESIZE);
+}
+
+}  // namespace
+
+///
+/// @class StatsPage
+/// A page of live statistics in shared memory.
+///
+/// The model publishes to the page every so often during a run, see
+/// Model::setStatsPage(). Publishing is a handful of stores into the page
+/// under a sequence lock, so it never waits for the readers; a reader that
+/// catches the page mid-update simply reads it again.
+///
+
+///
+/// Create the shared memory segment.
+///
+/// @param name The name of the segment, e.g., "/epideux". The segment is
+/// removed again when the page is destroyed.
+/// @param interval The shortest time between two publications.
+///
+StatsPage::StatsPage(const std::string& name,
+                     std::chrono::milliseconds interval)
+    : name_(segmentName(name)), interval_(interval) {
+  int fd = shm_open(name_.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+  if (fd < 0) {
+    throw std::runtime_error("Could not create shared memory " + name_);
+  }
+  if (ftruncate(fd, sizeof(StatsPageLayout)) != 0) {
+    close(fd);
+    shm_unlink(name_.c_str());
+    throw std::runtime_error("Could not size shared memory " + name_);
+  }
+  void* p = mmap(nullptr, sizeof(StatsPageLayout), PROT_READ | PROT_WRITE,
+                 MAP_SHARED, fd, 0);
+  close(fd);
+  if (p == MAP_FAILED) {
+    shm_unlink(name_.c_str());
+    throw std::runtime_error("Could not map shared memory " + name_);
+  }
+  // The segment starts out zeroed, so the sequence and words are valid.
+  page_ = static_cast<StatsPageLayout*>(p);
+  page_->version = kStatsPageVersion;
+  page_->size = sizeof(StatsPageLayout);
+  std::memcpy(page_->magic, kStatsPageMagic, sizeof(kStatsPageMagic));
+}
+
+StatsPage::~StatsPage() {
+  munmap(page_, sizeof(StatsPageLayout));
+  shm_unlink(name_.c_str());
+}
+
+const std::string& StatsPage::name() const { return name_; }
+
+///
+/// Whether the interval has passed since the last publication.
+///
+bool StatsPage::due() const {
+  return std::chrono::steady_clock::now() - last_publish_ >= interval_;
+}
+
+///
+/// Write the statistics to the page.
+///
+/// The wall time, the events per second since the last publication and the
+/// resident memory are filled in here.
+///
+void StatsPage::publish(StatsPageData data) {
+  auto now = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(now - last_publish_).count();
+  if ((data.events >= last_events_) && (seconds > 0.0) &&
+      (last_publish_.time_since_epoch().count() != 0)) {
+    events_per_second_ = (data.events - last_events_) / seconds;
+  }
+  last_publish_ = now;
+  last_events_ = data.events;
+  data.events_per_second = events_per_second_;
+  data.wall_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                       .count();
+  data.resident_bytes = residentBytes();
+
+  uint64_t words[kStatsPageWords];
+  std::memcpy(words, &data, sizeof(data));
+  uint64_t sequence = page_->sequence.load(std::memory_order_relaxed);
+  page_->sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  for (size_t i = 0; i < kStatsPageWords; ++i) {
+    page_->words[i].store(words[i], std::memory_order_relaxed);
+  }
+  page_->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+///
+/// @class StatsPageReader
+/// Opens the page of a model, possibly in another process, for reading.
+///
+
+StatsPageReader::StatsPageReader(const std::string& name) {
+  std::string segment = segmentName(name);
+  int fd = shm_open(segment.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    throw std::runtime_error("No statistics page " + segment);
+  }
+  void* p = mmap(nullptr, sizeof(StatsPageLayout), PROT_READ, MAP_SHARED, fd,
+                 0);
+  close(fd);
+  if (p == MAP_FAILED) {
+    throw std::runtime_error("Could not map statistics page " + segment);
+  }
+  page_ = static_cast<const StatsPageLayout*>(p);
+  if ((std::memcmp(page_->magic, kStatsPageMagic, sizeof(kStatsPageMagic)) !=
+       0) ||
+      (page_->version != kStatsPageVersion) ||
+      (page_->size != sizeof(StatsPageLayout))) {
+    munmap(const_cast<StatsPageLayout*>(page_), sizeof(StatsPageLayout));
+    throw std::runtime_error("Incompatible statistics page " + segment);
+  }
+}
+
+StatsPageReader::~StatsPageReader() {
+  munmap(const_cast<StatsPageLayout*>(page_), sizeof(StatsPageLayout));
+}
+
+///
+/// Take a consistent copy of the statistics.
+///
+/// @returns false if the model has not published yet, or the page kept
+/// changing while reading it.
+///
+bool StatsPageReader::read(StatsPageData& data) const {
+  for (int attempt = 0; attempt < 1000; ++attempt) {
+    uint64_t before = page_->sequence.load(std::memory_order_acquire);
+    if (before == 0) {
+      return false;
+    }
+    if (before & 1) {
+      continue;
+    }
+    uint64_t words[kStatsPageWords];
+    for (size_t i = 0; i < kStatsPageWords; ++i) {
+      words[i] = page_->words[i].load(std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (page_->sequence.load(std::memory_order_relaxed) == before) {
+      std::memcpy(&data, words, sizeof(data));
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace epideux
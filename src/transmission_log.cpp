@@ -0,0 +1,125 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+#include "epideux/transmission_log.h"
+
+namespace epideux {
+
+namespace {
+
+constexpr char kTransmissionMagic[8] = {'E', 'P', 'I', 'D',
+                                        'E', 'U', 'X', 'W'};
+constexpr uint32_t kTransmissionVersion = 1;
+
+bool writeAll(const void* data, size_t size, size_t count, FILE* file) {
+  return std::fwrite(data, size, count, file) == count;
+}
+
+}  // namespace
+
+///
+/// @class TransmissionLog
+/// An append-only store of who infected whom.
+///
+/// Attach the log with Model::setTransmissionLog. The records are stored in
+/// fixed-size chunks, so appending only allocates once per chunk and never
+/// moves the records already stored.
+///
+
+///
+/// Construct a transmission log.
+///
+/// @param chunk_records The number of records in each chunk.
+///
+TransmissionLog::TransmissionLog(size_t chunk_records)
+    : chunk_records_(chunk_records) {}
+
+void TransmissionLog::append(const TransmissionRecord& record) {
+  if (size_ == chunks_.size() * chunk_records_) {
+    chunks_.emplace_back(new TransmissionRecord[chunk_records_]);
+  }
+  chunks_.back()[size_ % chunk_records_] = record;
+  size_++;
+}
+
+size_t TransmissionLog::size() const { return size_; }
+
+const TransmissionRecord& TransmissionLog::operator[](size_t i) const {
+  return chunks_[i / chunk_records_][i % chunk_records_];
+}
+
+///
+/// Write the records to a binary file.
+///
+/// The file starts with the magic "EPIDEUXW", a uint32 version and a uint32
+/// record size, followed by the records. A failing write throws a
+/// std::runtime_error.
+///
+void TransmissionLog::exportBinary(const std::string& path) const {
+  FILE* file = std::fopen(path.c_str(), "wb");
+  if (file == nullptr) {
+    throw std::runtime_error("Could not open transmission file " + path);
+  }
+  uint32_t version = kTransmissionVersion;
+  uint32_t record_size = sizeof(TransmissionRecord);
+  bool written =
+      writeAll(kTransmissionMagic, 1, sizeof(kTransmissionMagic), file) &&
+      writeAll(&version, sizeof(version), 1, file) &&
+      writeAll(&record_size, sizeof(record_size), 1, file);
+  for (size_t c = 0; written && (c < chunks_.size()); ++c) {
+    size_t n = std::min(chunk_records_, size_ - c * chunk_records_);
+    written = writeAll(chunks_[c].get(), sizeof(TransmissionRecord), n, file);
+  }
+  // Closing flushes the last of the records, so it can fail as well.
+  if ((std::fclose(file) != 0) || !written) {
+    throw std::runtime_error("Could not write transmission file " + path);
+  }
+}
+
+///
+/// Write the records as a CSV edge list from infector to victim.
+///
+/// Unattributed infections have an empty infector. A failing write throws a
+/// std::runtime_error.
+///
+void TransmissionLog::exportEdgeList(const std::string& path) const {
+  FILE* file = std::fopen(path.c_str(), "w");
+  if (file == nullptr) {
+    throw std::runtime_error("Could not open transmission file " + path);
+  }
+  const char* header = "infector,victim,location,time_ns,num_infectious\n";
+  bool written = std::fputs(header, file) >= 0;
+  for (size_t i = 0; written && (i < size_); ++i) {
+    const TransmissionRecord& r = (*this)[i];
+    if (r.infector != kNoInfector) {
+      written = std::fprintf(file, "%u", r.infector) >= 0;
+    }
+    written = written &&
+              (std::fprintf(file, ",%u,%u,%lld,%u\n", r.victim, r.location,
+                            static_cast<long long>(r.time),
+                            r.num_infectious) >= 0);
+  }
+  if ((std::fclose(file) != 0) || !written) {
+    throw std::runtime_error("Could not write transmission file " + path);
+  }
+}
+
+}  // namespace epideux
@@ -0,0 +1,90 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include "epideux/epideux.h"
+
+// Count every heap allocation in the process.
+static std::atomic<uint64_t> num_allocations{0};
+
+void* operator new(size_t size) {
+  num_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete[](void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+int main(int argc, char const *argv[]) {
+  using namespace epideux;
+  using namespace std::chrono_literals;
+
+  constexpr int kNumPersons = 1000;
+  constexpr int kNumDays = 30;
+  Model sim_model;
+  sim_model.setStartDate(2020, 4, 1);
+  sim_model.setKeepDailyReports(false);
+  sim_model.seed(1);
+  time_pt now = sim_model.currentTime();
+  for (int l = 0; l < 20; ++l) {
+    sim_model.createLocation(0.5, "Location");
+  }
+  for (int i = 0; i < kNumPersons; ++i) {
+    Person& p = sim_model.createPerson(sim_model.getLocation(i % 10), 3*24h,
+                                       5*24h);
+    Location& work = sim_model.getLocation(10 + i % 10);
+    for (int day = 0; day < kNumDays; ++day) {
+      p.addItineraryEntry(
+          ItineraryEntry(work, now + day * 24h + 8h, now + day * 24h + 16h));
+    }
+  }
+  for (int i = 0; i < kNumPersons; i += 50) {
+    sim_model.getPerson(i).infect();
+  }
+
+  // The first days grow the containers to their working size.
+  sim_model.simulate(10*24h);
+
+  // Every day has two moves per person and a report. The run ends with the
+  // stop event.
+  constexpr int kMeasuredDays = 10;
+  uint64_t num_events = kMeasuredDays * (2 * kNumPersons + 1) + 1;
+  uint64_t before = num_allocations.load(std::memory_order_relaxed);
+  sim_model.simulate(kMeasuredDays*24h);
+  uint64_t allocations = num_allocations.load(std::memory_order_relaxed) - before;
+
+  std::cout << "allocation free: " << (allocations == 0)
+            << " events: " << num_events << " allocations: " << allocations
+            << " per event: " << double(allocations) / num_events
+            << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,130 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "epideux/epideux_c.h"
+
+int main(int argc, char const *argv[]) {
+  epideux_model* model = epideux_model_create();
+  epideux_set_start_date(model, 2020, 4, 1);
+  epideux_seed(model, 1);
+
+  double beta[2] = {5.0, 5.0};
+  uint32_t first_location = 0;
+  epideux_add_locations(model, 2, beta, &first_location);
+
+  // Two homes of ten, with one day of incubation, three days of disease and
+  // the remaining durations never passing.
+  uint32_t num_durations = epideux_num_durations();
+  uint32_t home[20];
+  double* durations = malloc(20 * num_durations * sizeof(double));
+  for (int i = 0; i < 20; ++i) {
+    home[i] = first_location + i / 10;
+    for (uint32_t d = 0; d < num_durations; ++d) {
+      durations[i * num_durations + d] = d < 2 ? (1 + 2 * d) * 86400.0
+                                               : INFINITY;
+    }
+  }
+  uint32_t first_person = 0;
+  epideux_add_persons(model, 20, home, durations, &first_person);
+  free(durations);
+
+  // The first person visits the other home.
+  uint32_t person[1] = {first_person};
+  uint32_t location[1] = {first_location + 1};
+  double start[1] = {3600.0};
+  double end[1] = {7200.0};
+  epideux_add_itinerary(model, 1, person, location, start, end);
+  epideux_infect(model, 1, person);
+  epideux_status status = epideux_simulate(model, 30 * 86400.0);
+
+  // Every report accounts for all persons.
+  size_t num_reports = epideux_num_reports(model);
+  uint32_t num_states = epideux_num_states();
+  uint32_t* reports = malloc(num_reports * num_states * sizeof(uint32_t));
+  int counts_ok =
+      epideux_get_reports(model, reports, num_reports - 1) ==
+          EPIDEUX_ERROR_BUFFER_TOO_SMALL &&
+      epideux_get_reports(model, reports, num_reports) == EPIDEUX_OK;
+  for (size_t r = 0; r < num_reports; ++r) {
+    uint32_t total = 0;
+    for (uint32_t s = 0; s < num_states; ++s) {
+      total += reports[r * num_states + s];
+    }
+    counts_ok &= total == 20;
+  }
+  free(reports);
+
+  uint8_t states[20];
+  uint32_t locations[20];
+  int persons_ok =
+      epideux_get_person_states(model, states, 20) == EPIDEUX_OK &&
+      epideux_get_person_locations(model, locations, 20) == EPIDEUX_OK &&
+      states[0] != 0 && locations[0] == first_location &&
+      locations[19] == first_location + 1;
+
+  // Bad ids are reported, not thrown.
+  uint32_t bad_person[1] = {1000};
+  int errors_ok = epideux_infect(model, 1, bad_person) ==
+                      EPIDEUX_ERROR_OUT_OF_RANGE &&
+                  epideux_last_error(model)[0] != '\0';
+
+  epideux_model_destroy(model);
+
+  // A batch with a bad row changes nothing, and times outside the clock are
+  // refused rather than wrapped.
+  epideux_model* batch = epideux_model_create();
+  uint32_t rooms = 0;
+  epideux_add_locations(batch, 2, beta, &rooms);
+  uint32_t guest = 0;
+  double guest_durations[16] = {86400.0, 86400.0};
+  for (uint32_t d = 2; d < num_durations; ++d) {
+    guest_durations[d] = INFINITY;
+  }
+  epideux_add_persons(batch, 1, &rooms, guest_durations, &guest);
+  uint32_t visitors[2] = {guest, guest};
+  uint32_t visited[2] = {rooms + 1, 1000};
+  double starts[2] = {3600.0, 3600.0};
+  double ends[2] = {7200.0, 7200.0};
+  double nan_start[1] = {NAN};
+  double huge_end[1] = {1e300};
+  uint32_t infected[2] = {guest, 1000};
+  int batch_ok =
+      epideux_add_itinerary(batch, 2, visitors, visited, starts, ends) ==
+          EPIDEUX_ERROR_OUT_OF_RANGE &&
+      epideux_infect(batch, 2, infected) == EPIDEUX_ERROR_OUT_OF_RANGE &&
+      epideux_add_itinerary(batch, 1, visitors, visited, nan_start, ends) ==
+          EPIDEUX_ERROR_OUT_OF_RANGE &&
+      epideux_add_itinerary(batch, 1, visitors, visited, starts, huge_end) ==
+          EPIDEUX_ERROR_OUT_OF_RANGE &&
+      epideux_simulate(batch, INFINITY) == EPIDEUX_ERROR_OUT_OF_RANGE &&
+      epideux_simulate(batch, NAN) == EPIDEUX_ERROR_OUT_OF_RANGE &&
+      epideux_simulate(batch, 5400.0) == EPIDEUX_OK &&
+      epideux_get_person_states(batch, states, 1) == EPIDEUX_OK &&
+      epideux_get_person_locations(batch, locations, 1) == EPIDEUX_OK &&
+      states[0] == 0 && locations[0] == rooms;
+  epideux_model_destroy(batch);
+
+  printf("status: %d reports: %zu counts: %d persons: %d errors: %d "
+         "batch: %d\n",
+         status, num_reports, counts_ok, persons_ok, errors_ok, batch_ok);
+  return 0;
+}
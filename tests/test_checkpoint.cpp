@@ -0,0 +1,107 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <iostream>
+#include "epideux/epideux.h"
+#include "scratch_file.h"
+
+using namespace epideux;
+using namespace std::chrono_literals;
+
+void buildScenario(Model& sim_model, TransmissionModel transmission_model) {
+  sim_model.setStartDate(2020, 4, 1);
+  sim_model.setTransmissionModel(transmission_model);
+  Location& work = sim_model.createLocation(3.0, "Work");
+  for (int h = 0; h < 5; ++h) {
+    Location& home = sim_model.createLocation(2.0, "Home");
+    for (int i = 0; i < 6; ++i) {
+      Person& p = sim_model.createPerson(home, 2*24h, 5*24h);
+      for (int day = 0; day < 40; ++day) {
+        time_pt start = sim_model.currentTime() + day*24h + 8h;
+        p.addItineraryEntry(ItineraryEntry(work, start, start + 8h));
+      }
+    }
+  }
+  sim_model.getPerson(0).infect();
+}
+
+bool sameReports(const SeirTimeline& a, const SeirTimeline& b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); ++i) {
+    for (size_t s = 0; s < DiseaseModel::num_states; ++s) {
+      if (reportCount(a[i], s) != reportCount(b[i], s)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Run straight through, and stop halfway to continue from a checkpoint in a
+// fresh model. Both must end in the same state.
+bool checkpointMatches(TransmissionModel transmission_model,
+                       const std::string& checkpoint_file) {
+  Model original;
+  buildScenario(original, transmission_model);
+  original.seed(7);
+  original.simulate(3*24h);
+  original.saveCheckpoint(checkpoint_file);
+  original.simulate(10*24h);
+
+  Model restored;
+  buildScenario(restored, transmission_model);
+  restored.seed(99);
+  restored.loadCheckpoint(checkpoint_file);
+  restored.simulate(10*24h);
+
+  bool same = sameReports(original.getDailyReports(),
+                          restored.getDailyReports()) &&
+              (original.currentTime() == restored.currentTime());
+  for (uint32_t i = 0; i < 30; ++i) {
+    same &= original.getPerson(i).infectionState() ==
+            restored.getPerson(i).infectionState();
+    same &= original.getPerson(i).currentLocation().id() ==
+            restored.getPerson(i).currentLocation().id();
+  }
+  return same && (original.getReport().susceptible < 30);
+}
+
+int main(int argc, char const *argv[]) {
+  ScratchFile checkpoint_file("checkpoint.bin");
+  bool binomial = checkpointMatches(TransmissionModel::Binomial,
+                                    checkpoint_file.path());
+  bool exposure = checkpointMatches(TransmissionModel::ExposureAccumulation,
+                                    checkpoint_file.path());
+
+  // A checkpoint of another scenario is refused.
+  Model other;
+  other.createLocation(1.0, "Home");
+  bool refused = false;
+  try {
+    other.loadCheckpoint(checkpoint_file.path());
+  } catch (const std::runtime_error&) {
+    refused = true;
+  }
+
+  std::cout << "binomial: " << binomial << " exposure: " << exposure
+            << " refused: " << refused << std::endl;
+
+  return 0;
+}
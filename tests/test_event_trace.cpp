@@ -0,0 +1,79 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include "epideux/epideux.h"
+#include "epideux/event_trace.h"
+#include "scratch_file.h"
+
+int main(int argc, char const *argv[]) {
+  using namespace epideux;
+  using namespace std::chrono_literals;
+
+  Model sim_model;
+  sim_model.setStartDate(2020, 4, 1);
+  // Small buffers, so the writer thread gets several of them.
+  ScratchFile trace_file("trace.bin");
+  auto event_trace = std::make_shared<EventTrace>(trace_file.path(), 4);
+  sim_model.setEventTrace(event_trace);
+
+  // No transmission, so the seed is the only infection in every disease
+  // model.
+  Location& location1 = sim_model.createLocation(0.0, "Location1");
+  Location& location2 = sim_model.createLocation(0.0, "Location2");
+  time_pt start_time = sim_model.currentTime() + 1h;
+  ItineraryEntry loc2_it(location2, start_time, start_time + 2h);
+  for (int i = 0; i < 10; ++i) {
+    Person& my_person = sim_model.createPerson(location1, 4*24h, 7*24h);
+    my_person.addItineraryEntry(loc2_it);
+  }
+  sim_model.getPerson(0).infect();
+  sim_model.simulate(4h);
+
+  // Ten begin, end and two moves each, plus the infection.
+  std::ifstream trace_in(trace_file.path(), std::ios::binary);
+  TraceFileHeader header;
+  trace_in.read(reinterpret_cast<char*>(&header), sizeof(header));
+  int counts[5] = {};
+  TraceRecord record;
+  while (trace_in.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+    counts[static_cast<int>(record.kind)]++;
+  }
+  std::cout << "Records: " << event_trace->numRecords() << " kinds:";
+  for (int c : counts) {
+    std::cout << ' ' << c;
+  }
+  std::cout << " states: " << (header.num_states == DiseaseModel::num_states);
+
+  // Records that cannot be written are reported, and not counted.
+  bool failure_reported = false;
+  EventTrace full("/dev/full", 1024);
+  for (int i = 0; i < 10000; ++i) {
+    full.record(i, TraceEventKind::Move, 0, 0, 0);
+  }
+  try {
+    full.flush();
+  } catch (const std::runtime_error&) {
+    failure_reported = true;
+  }
+  std::cout << " failure: " << failure_reported << ' '
+            << (full.numRecords() < 10000) << std::endl;
+
+  return 0;
+}
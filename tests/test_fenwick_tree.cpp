@@ -0,0 +1,53 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <iostream>
+#include "epideux/fenwick_tree.h"
+
+int main(int argc, char const *argv[]) {
+  using namespace epideux;
+
+  FenwickTree tree;
+  for (double w : {1.0, 0.0, 3.0, 2.0, 0.5}) {
+    tree.pushBack(w);
+  }
+
+  // Cumulative weights: 1, 1, 4, 6, 6.5
+  std::cout << "total: " << tree.total();
+  std::cout << " find:";
+  for (double u : {0.0, 0.99, 1.0, 3.99, 4.0, 6.4}) {
+    std::cout << ' ' << tree.find(u);
+  }
+
+  tree.set(0, 0.0);
+  tree.set(2, 0.0);
+  std::cout << " after set: " << tree.total() << ' ' << tree.find(0.0) << ' '
+            << tree.find(2.1);
+
+  // Zeroing weights that are not exact in binary leaves a residue in the
+  // total, which must not select an index with no weight.
+  FenwickTree residue;
+  for (double w : {0.1, 0.2}) {
+    residue.pushBack(w);
+  }
+  residue.set(0, 0.0);
+  residue.set(1, 0.0);
+  std::cout << " residue: " << (residue.total() > 0.0) << ' '
+            << residue.find(0.5 * residue.total()) << std::endl;
+
+  return 0;
+}
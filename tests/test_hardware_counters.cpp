@@ -0,0 +1,70 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <iostream>
+#include "epideux/epideux.h"
+#include "epideux/hardware_counters.h"
+
+int main(int argc, char const *argv[]) {
+  using namespace epideux;
+  using namespace std::chrono_literals;
+
+  // Everybody moves between three shops every hour of the working day, so
+  // most of the run is movement, and the location updates happen within it.
+  Model sim_model;
+  auto counters = std::make_shared<HardwareCounters>();
+  sim_model.setHardwareCounters(counters);
+  sim_model.setStartDate(2020, 4, 1);
+  Location& home = sim_model.createLocation(1.0, "Home");
+  Location* shops[3];
+  for (auto& shop : shops) {
+    shop = &sim_model.createLocation(20.0, "Shop");
+  }
+  time_pt now = sim_model.currentTime();
+  for (int i = 0; i < 12; ++i) {
+    Person& p = sim_model.createPerson(home, 1h, 3*24h);
+    for (int hour = 0; hour < 10; ++hour) {
+      time_pt start = now + 8h + hour*1h;
+      p.addItineraryEntry(
+          ItineraryEntry(*shops[(i + hour) % 3], start, start + 50min));
+    }
+  }
+  sim_model.getPerson(0).infect();
+  sim_model.simulate(2*24h);
+
+  // Where the counters can be opened, the phases are attributed instructions.
+  // Elsewhere the model runs without them, and nothing is attributed.
+  bool available = counters->available();
+  bool counted =
+      available && counters->available(HardwareEvent::Instructions);
+  size_t instructions = static_cast<size_t>(HardwareEvent::Instructions);
+  uint64_t movement = counters->phase(StatsPhase::Movement)[instructions];
+  uint64_t update = counters->phase(StatsPhase::LocationUpdate)[instructions];
+  uint64_t report = counters->phase(StatsPhase::Report)[instructions];
+  std::cout << "movement: " << ((movement > 0) == counted)
+            << " update: " << (update <= movement + report)
+            << " error: " << (counters->error().empty() == available)
+            << " infected: " << (sim_model.getReport().susceptible < 12);
+
+  counters->reset();
+  std::cout << " reset: "
+            << (counters->phase(StatsPhase::Movement)[instructions] == 0)
+            << " available: " << available << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,56 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <iostream>
+#include "epideux/location_recorder.h"
+
+int main(int argc, char const *argv[]) {
+  using namespace epideux;
+  using namespace std::chrono_literals;
+
+  Model sim_model;
+  sim_model.setStartDate(2020, 4, 1);
+  auto recorder = std::make_shared<LocationRecorder>(16);
+  sim_model.setLocationRecorder(recorder);
+
+  Location& location1 = sim_model.createLocation(0.7, "Location1");
+  Location& location2 = sim_model.createLocation(0.7, "Location2");
+  for (int i = 0; i < 20; ++i) {
+    sim_model.createLocation(0.7);
+  }
+
+  // Away from location1 over the second report.
+  time_pt start_time = sim_model.currentTime() + 1h;
+  ItineraryEntry loc2_it(location2, start_time, start_time + 35h);
+  for (int i = 0; i < 10; ++i) {
+    Person& my_person = sim_model.createPerson(location1, 4*24h, 7*24h);
+    my_person.addItineraryEntry(loc2_it);
+  }
+
+  sim_model.simulate(3*24h);
+
+  std::cout << "Ticks: " << recorder->numTicks() << " occupancy 1/2:";
+  auto series1 = recorder->series(location1.id());
+  auto series2 = recorder->series(location2.id());
+  for (size_t i = 0; i < series1.size(); ++i) {
+    std::cout << ' ' << series1[i].second.susceptible << '/'
+              << series2[i].second.susceptible;
+  }
+  std::cout << " bytes: " << recorder->encodedBytes() << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,68 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <iostream>
+#include <sstream>
+#include "epideux/epideux.h"
+#include "spdlog/sinks/ostream_sink.h"
+#include "spdlog/spdlog.h"
+
+int main(int argc, char const *argv[]) {
+  using namespace epideux;
+  using namespace std::chrono_literals;
+
+  // One visit is enough for every kind of message: the start and stop of the
+  // runs, and the dispatched events.
+  Model sim_model;
+  sim_model.setStartDate(2020, 4, 1);
+  Location& home = sim_model.createLocation(1.0, "Home");
+  Location& shop = sim_model.createLocation(1.0, "Shop");
+  time_pt now = sim_model.currentTime();
+  sim_model.createPerson(home, 1*24h, 3*24h)
+      .addItineraryEntry(ItineraryEntry(shop, now + 10h, now + 11h));
+
+  // Without a logger the model does not log at all.
+  sim_model.simulate(1*24h);
+
+  std::ostringstream log;
+  auto sink = std::make_shared<spdlog::sinks::ostream_sink_st>(log);
+  auto logger = std::make_shared<spdlog::logger>("test", sink);
+  logger->set_level(spdlog::level::trace);
+  logger->set_pattern("%l %v");
+  sim_model.setLogger(logger);
+  sim_model.simulate(1*24h);
+  sim_model.simulateFixedStep(1*24h, 1h);
+
+  // The traces are compiled in with EPIDEUX_LOG_LEVEL=TRACE only, and the
+  // debug messages with TRACE or DEBUG.
+  std::string text = log.str();
+  auto logged = [&text](const char* message) {
+    return text.find(message) != std::string::npos;
+  };
+  std::cout << "started: " << logged("debug Starting simulation [simtime: ")
+            << " stopped: " << logged("debug Stopping fixed-step simulation")
+            << " dispatched: " << logged("trace Dispatched event");
+
+  // Messages above the logger's level are not formatted.
+  log.str("");
+  logger->set_level(spdlog::level::info);
+  sim_model.simulate(1*24h);
+  std::cout << " filtered: " << log.str().empty() << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,64 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <iostream>
+#include "epideux/epideux.h"
+#include "scratch_file.h"
+
+using namespace epideux;
+using namespace std::chrono_literals;
+
+SeirReport run(bool mapped, size_t& used) {
+  Model sim_model;
+  ScratchFile storage_file("person_storage.bin");
+  if (mapped) {
+    sim_model.mapPersonStorage(storage_file.path(), size_t(1) << 30);
+  }
+  sim_model.setStartDate(2020, 4, 1);
+  sim_model.seed(5);
+  Location& work = sim_model.createLocation(3.0, "Work");
+  for (int h = 0; h < 10; ++h) {
+    Location& home = sim_model.createLocation(2.0, "Home");
+    for (int i = 0; i < 4; ++i) {
+      Person& p = sim_model.createPerson(home, 2*24h, 5*24h);
+      for (int day = 0; day < 30; ++day) {
+        time_pt start = sim_model.currentTime() + day*24h + 8h;
+        p.addItineraryEntry(ItineraryEntry(work, start, start + 8h));
+      }
+    }
+  }
+  sim_model.getPerson(0).infect();
+  sim_model.simulate(30*24h);
+  used = sim_model.personStorage().used();
+  return sim_model.getReport();
+}
+
+int main(int argc, char const *argv[]) {
+  size_t used_in_memory = 0;
+  size_t used_in_file = 0;
+  SeirReport in_memory = run(false, used_in_memory);
+  SeirReport in_file = run(true, used_in_file);
+
+  // The storage does not change the simulation.
+  bool same = (in_memory.susceptible == in_file.susceptible) &&
+              (in_memory.recovered == in_file.recovered);
+  std::cout << "same: " << same << " in memory: " << used_in_memory
+            << " in file: " << (used_in_file > 40 * 30 * 32) << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,134 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include "epideux/epideux.h"
+
+// Count the bytes the program holds on the heap, to check the report
+// against. Each block carries its size in front of it.
+namespace {
+constexpr size_t kHeader = 16;
+size_t live_bytes = 0;
+}  // namespace
+
+void* operator new(size_t size) {
+  char* block = static_cast<char*>(std::malloc(size + kHeader));
+  if (!block) {
+    throw std::bad_alloc();
+  }
+  *reinterpret_cast<size_t*>(block) = size;
+  live_bytes += size;
+  return block + kHeader;
+}
+
+void operator delete(void* p) noexcept {
+  if (p) {
+    char* block = static_cast<char*>(p) - kHeader;
+    live_bytes -= *reinterpret_cast<size_t*>(block);
+    std::free(block);
+  }
+}
+
+void operator delete(void* p, size_t) noexcept { operator delete(p); }
+
+void* operator new(size_t size, std::align_val_t alignment) {
+  size_t offset = std::max(kHeader, static_cast<size_t>(alignment));
+  char* block = static_cast<char*>(
+      std::aligned_alloc(static_cast<size_t>(alignment),
+                         (offset + size + offset - 1) / offset * offset));
+  if (!block) {
+    throw std::bad_alloc();
+  }
+  *reinterpret_cast<size_t*>(block + offset - kHeader) = size;
+  live_bytes += size;
+  return block + offset;
+}
+
+void operator delete(void* p, std::align_val_t alignment) noexcept {
+  if (p) {
+    size_t offset = std::max(kHeader, static_cast<size_t>(alignment));
+    char* block = static_cast<char*>(p) - offset;
+    live_bytes -= *reinterpret_cast<size_t*>(block + offset - kHeader);
+    std::free(block);
+  }
+}
+
+void operator delete(void* p, size_t, std::align_val_t alignment) noexcept {
+  operator delete(p, alignment);
+}
+
+int main(int argc, char const *argv[]) {
+  using namespace epideux;
+  using namespace std::chrono_literals;
+
+  ScenarioCounts counts;
+  counts.num_persons = 2000;
+  counts.num_locations = 100;
+  counts.num_itinerary_entries = 4000;
+  counts.names_size = 100 * 27;
+  counts.num_reports = 10;
+
+  Model sim_model;
+  sim_model.setStartDate(2020, 4, 1);
+  size_t empty_bytes = live_bytes;
+  time_pt now = sim_model.currentTime();
+  for (size_t l = 0; l < counts.num_locations; ++l) {
+    sim_model.createLocation(5.0, "A location with a long name");
+  }
+  for (uint32_t i = 0; i < counts.num_persons; ++i) {
+    Person& p =
+        sim_model.createPerson(sim_model.getLocation(i % 50), 1*24h, 3*24h);
+    Location& work = sim_model.getLocation(50 + i % 50);
+    p.addItineraryEntry(ItineraryEntry(work, now + 8h, now + 16h));
+    p.addItineraryEntry(ItineraryEntry(work, now + 32h, now + 40h));
+  }
+  sim_model.getPerson(0).infect();
+
+  MemoryReport built = sim_model.memoryReport();
+  size_t measured = live_bytes - empty_bytes;
+  sim_model.simulate(10*24h);
+  MemoryReport run = sim_model.memoryReport();
+  size_t measured_run = live_bytes - empty_bytes;
+  MemoryReport estimate = Model::estimateMemory(counts);
+
+  // The report adds the allocator's bookkeeping to the bytes asked for, so it
+  // comes out slightly above the count.
+  auto matches = [](const MemoryReport& report, size_t bytes) {
+    return std::abs(double(report.total()) - double(bytes)) < 0.1 * bytes;
+  };
+  // Construction only leaves the itinerary events in the schedule, while the
+  // estimate is for the peak of the run. The schedule keeps its capacity.
+  bool ok = matches(built, measured) && matches(run, measured_run) &&
+            (built.persons == estimate.persons) &&
+            (built.itinerary == estimate.itinerary) &&
+            (built.occupancy == estimate.occupancy) &&
+            (built.location_names == estimate.location_names) &&
+            (run.reports > 0) && (run.schedule >= built.schedule) &&
+            (std::abs(double(estimate.total()) - double(built.total())) <
+             0.2 * built.total());
+  std::cout << "ok: " << ok << " built: " << built.total()
+            << " measured: " << measured << " run: " << run.total()
+            << " measured: " << measured_run
+            << " estimate: " << estimate.total() << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,74 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <iostream>
+#include "epideux/epideux.h"
+
+int main(int argc, char const *argv[]) {
+  using namespace epideux;
+  using namespace std::chrono_literals;
+
+  // Three households of two go to a shared office on the first day and to a
+  // shop on the second, which gives every kind of event a known count.
+  Model sim_model;
+  sim_model.setStartDate(2020, 4, 1);
+  Location& office = sim_model.createLocation(5.0, "Office");
+  Location& shop = sim_model.createLocation(2.0, "Shop");
+  time_pt now = sim_model.currentTime();
+  for (int h = 0; h < 3; ++h) {
+    Location& home = sim_model.createLocation(1.0, "Home");
+    for (int i = 0; i < 2; ++i) {
+      Person& p = sim_model.createPerson(home, 1*24h, 3*24h);
+      p.addItineraryEntry(ItineraryEntry(office, now + 8h, now + 16h));
+      p.addItineraryEntry(ItineraryEntry(shop, now + 34h, now + 35h));
+    }
+  }
+  sim_model.getPerson(0).infect();
+  sim_model.simulate(3*24h);
+
+  // With the counters compiled in, they add up to the run; without them they
+  // are all zero.
+#if defined(EPIDEUX_ENABLE_STATS)
+  const bool counted = true;
+#else
+  const bool counted = false;
+#endif
+  ModelStats stats = sim_model.stats();
+  auto events = [&stats](ScheduledEvent event) {
+    return stats.events[static_cast<size_t>(event)];
+  };
+  uint64_t infections =
+      counted ? 6 - sim_model.getReport().susceptible - 1 : 0;
+  double movement_seconds =
+      stats.phase_seconds[static_cast<size_t>(StatsPhase::Movement)];
+  std::cout << "events: " << events(ScheduledEvent::BeginItineraryEntry)
+            << '/' << events(ScheduledEvent::EndItineraryEntry) << '/'
+            << events(ScheduledEvent::Report)
+            << " schedule: " << stats.peak_schedule_size
+            << " infections: " << (stats.infections == infections)
+            << " updates: " << ((stats.update_infections_calls > 0) == counted)
+            << " visited: " << ((stats.occupants_visited > 0) == counted)
+            << " movement time: " << ((movement_seconds > 0.0) == counted);
+
+  sim_model.resetStats();
+  stats = sim_model.stats();
+  std::cout << " reset: "
+            << (events(ScheduledEvent::BeginItineraryEntry) == 0) << std::endl;
+
+  return 0;
+}
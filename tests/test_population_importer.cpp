@@ -0,0 +1,91 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include "epideux/population_importer.h"
+#include "scratch_file.h"
+
+int main(int argc, char const *argv[]) {
+  using namespace epideux;
+  using namespace std::chrono_literals;
+
+  ScratchFile locations_file("locations.csv");
+  ScratchFile persons_file("persons.csv");
+  ScratchFile visits_file("visits.csv");
+  {
+    std::ofstream locations(locations_file.path());
+    locations << "id,beta,name\n0,0.7,Home\n1,0.7,Work\r\n";
+    std::ofstream persons(persons_file.path());
+    persons << "id,home\n";
+    for (int i = 0; i < 10; ++i) {
+      persons << i << ",0\n";
+    }
+    // Visits out of order and without a final newline. The shop has a sparse
+    // id.
+    std::ofstream visits(visits_file.path());
+    for (int i = 9; i >= 0; --i) {
+      visits << i << ",4000000000,36000,72000\n";
+      visits << i << ",1,3600,10800";
+      if (i > 0) {
+        visits << '\n';
+      }
+    }
+  }
+
+  Model sim_model;
+  sim_model.setStartDate(2020, 4, 1);
+  PopulationImporter importer(sim_model);
+  importer.setDefaultBeta(0.5);
+  importer.importLocations(locations_file.path());
+  importer.importPersons(persons_file.path());
+  ImportStats stats = importer.importVisits(visits_file.path());
+  importer.finish();
+
+  Person& person = sim_model.getPerson(0);
+  Location& home = person.home();
+  Location& work = person.itinerary().front().location();
+  Location& shop = person.itinerary().back().location();
+  std::cout << "Visits: " << stats.rows << ' ' << home.name() << '/'
+            << work.name() << ": " << home.getPersons().size() << '/'
+            << work.getPersons().size() << '/' << shop.getPersons().size();
+
+  sim_model.simulate(2h);
+  std::cout << " (2h) " << home.getPersons().size() << '/'
+            << work.getPersons().size() << '/' << shop.getPersons().size();
+
+  sim_model.simulate(9h);
+  std::cout << " (11h) " << home.getPersons().size() << '/'
+            << work.getPersons().size() << '/' << shop.getPersons().size();
+
+  // An id that does not fit 64 bits is a malformed row, not a wrapped id.
+  {
+    std::ofstream overflow(persons_file.path());
+    overflow << "18446744073709551616,0\n";
+  }
+  int refused = 0;
+  try {
+    PopulationImporter(sim_model).importPersons(persons_file.path());
+  } catch (const std::runtime_error&) {
+    refused = 1;
+  }
+  std::cout << " refused: " << refused << " locations: "
+            << sim_model.numLocations() << std::endl;
+
+  return 0;
+}
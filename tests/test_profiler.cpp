@@ -0,0 +1,77 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include "epideux/epideux.h"
+#include "epideux/profiler.h"
+#include "scratch_file.h"
+
+int main(int argc, char const *argv[]) {
+  using namespace epideux;
+  using namespace std::chrono_literals;
+
+  // A single visit by a single person gives the engine a known number of
+  // zones: one per dispatched event, move, location update and report.
+  Model sim_model;
+  sim_model.setStartDate(2020, 4, 1);
+  Location& home = sim_model.createLocation(1.0, "Home");
+  Location& shop = sim_model.createLocation(1.0, "Shop");
+  time_pt now = sim_model.currentTime();
+  sim_model.createPerson(home, 1*24h, 3*24h)
+      .addItineraryEntry(ItineraryEntry(shop, now + 10h, now + 11h));
+
+  // Zones outside start() and stop() are not recorded.
+  { ProfileZone zone("ignored"); }
+  Profiler::start();
+  sim_model.simulate(1*24h);
+  size_t engine_records = Profiler::numRecords();
+  // Every thread gets its own track.
+  std::thread worker([] {
+    for (int i = 0; i < 5000; ++i) {
+      ProfileZone zone("worker");
+    }
+  });
+  worker.join();
+  { ProfileZone zone("main"); }
+  Profiler::stop();
+  { ProfileZone zone("ignored"); }
+  size_t zones = Profiler::numRecords() - engine_records;
+
+  ScratchFile profile_file("profile.json");
+  Profiler::writeChromeTrace(profile_file.path());
+  std::ifstream in(profile_file.path());
+  std::stringstream trace;
+  trace << in.rdbuf();
+  std::string json = trace.str();
+  auto contains = [&json](const char* text) {
+    return json.find(text) != std::string::npos;
+  };
+  std::cout << "engine: " << engine_records << " zones: " << zones
+            << " worker: " << contains("\"name\":\"worker\",\"ph\":\"X\"")
+            << " main: " << contains("\"main\"")
+            << " ignored: " << contains("ignored")
+            << " updates: " << contains("Location::updateInfections");
+
+  Profiler::clear();
+  std::cout << " cleared: " << (Profiler::numRecords() == 0) << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,76 @@
+# Epideux - Agent Based Location-Graph Epidemic Simulation
+#
+# Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+# Drive the model from Python through the extension module.
+
+import array
+
+import epideux
+
+model = epideux.Model()
+model.set_start_date(2020, 4, 1)
+model.seed(3)
+home = model.add_locations(array.array("d", [5.0, 5.0]), names=["A", "B"])
+# One row of durations in days per person, with lifelong immunity.
+row = [1.0, 3.0][-epideux.num_durations:] + \
+    [float("inf")] * max(epideux.num_durations - 2, 0)
+first = model.add_persons(
+    array.array("I", [home] * 10 + [home + 1] * 10),
+    memoryview(array.array("d", row * 20)).cast("B").cast(
+        "d", [20, epideux.num_durations]))
+model.add_itinerary(array.array("I", [first]), array.array("I", [home + 1]),
+                    array.array("d", [3600.0]), array.array("d", [7200.0]))
+model.infect(array.array("I", [first]))
+model.simulate(30)
+
+reports = model.reports()
+states = model.person_states()
+try:
+    model.simulate(1)
+    blocked = False
+except BufferError:
+    blocked = True
+days, num_states = reports.shape
+counts_add_up = all(sum(reports[d, s] for s in range(num_states)) == 20
+                    for d in range(days))
+reports.release()
+states_ok = len(states) == 20 and states[0] != 0
+states.release()
+model.simulate(1)
+
+# A batch with a bad row changes nothing, and ids must be whole numbers in
+# range.
+validated = True
+try:
+    model.add_persons(
+        array.array("I", [home, home + 2]),
+        memoryview(array.array("d", row * 2)).cast("B").cast(
+            "d", [2, epideux.num_durations]))
+    validated = False
+except IndexError:
+    validated &= model.num_persons() == 20
+for ids in (array.array("d", [float("nan")]), array.array("d", [0.5]),
+            array.array("q", [-1]), array.array("Q", [2**32])):
+    try:
+        model.infect(ids)
+        validated = False
+    except ValueError:
+        pass
+
+print("days:", days, "states:", num_states == len(epideux.states),
+      "counts:", counts_add_up, "person states:", states_ok,
+      "blocked:", blocked, "validated:", validated)
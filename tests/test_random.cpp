@@ -0,0 +1,94 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+#include "epideux/random.h"
+
+// The mean of uniform doubles drawn from a generator.
+template <typename Generator>
+double uniformMean(Generator& gen, size_t n) {
+  std::uniform_real_distribution<double> dist;
+  double sum = 0.0;
+  for (size_t i = 0; i < n; ++i) {
+    sum += dist(gen);
+  }
+  return sum / n;
+}
+
+int main(int argc, char const *argv[]) {
+  using namespace epideux;
+
+  const size_t n = 100003;
+  Xoshiro256ppX4 gen(42);
+  std::vector<double> values(n);
+
+  fillUniform(gen, values.data(), n);
+  double sum = 0.0;
+  for (double v : values) {
+    sum += v;
+  }
+  bool uniform_ok = std::abs(sum / n - 0.5) < 0.01;
+
+  fillExponential(gen, values.data(), n, 2.0);
+  sum = 0.0;
+  for (double v : values) {
+    sum += v;
+  }
+  bool exponential_ok = std::abs(sum / n - 0.5) < 0.01;
+
+  // Check both the inversion and the fallback for large means.
+  RandomBuffer buffer(42);
+  bool binomial_ok = true;
+  for (auto np : {std::make_pair(20u, 0.1), std::make_pair(1000u, 0.3),
+                  std::make_pair(50u, 0.9)}) {
+    sum = 0.0;
+    for (size_t i = 0; i < 10000; ++i) {
+      sum += buffer.binomial(np.first, np.second);
+    }
+    double mean = np.first * np.second;
+    binomial_ok &= std::abs(sum / 10000 - mean) < 0.05 * mean;
+  }
+
+  // The scalar generators reproduce the reference outputs: xoshiro256++ from
+  // the state {1, 2, 3, 4}, and PCG32 from the pcg32_srandom(42, 54) state.
+  Xoshiro256pp xoshiro;
+  std::istringstream("1 2 3 4") >> xoshiro;
+  bool xoshiro_ok = (xoshiro() == 41943041ULL) && (xoshiro() == 58720359ULL) &&
+                    (xoshiro() == 3588806011781223ULL);
+  xoshiro.seed(42);
+  xoshiro_ok &= std::abs(uniformMean(xoshiro, n) - 0.5) < 0.01;
+
+  Pcg32 pcg;
+  std::istringstream("1753877967969059832 109") >> pcg;
+  bool pcg_ok = (pcg() == 0xa15c02b7u) && (pcg() == 0x7b47f409u);
+  // Two 32 bit outputs make up one buffer value.
+  uint64_t bits;
+  fillBits(pcg, &bits, 1);
+  pcg_ok &= bits == 0xba1d333083d2f293ULL;
+  pcg.seed(42);
+  pcg_ok &= std::abs(uniformMean(pcg, n) - 0.5) < 0.01;
+
+  std::cout << "uniform: " << uniform_ok << " exponential: " << exponential_ok
+            << " binomial: " << binomial_ok << " xoshiro256pp: " << xoshiro_ok
+            << " pcg32: " << pcg_ok << std::endl;
+
+  return 0;
+}
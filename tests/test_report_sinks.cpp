@@ -0,0 +1,122 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include "epideux/report_sink.h"
+#include "scratch_file.h"
+
+int main(int argc, char const *argv[]) {
+  using namespace epideux;
+  using namespace std::chrono_literals;
+
+  Model sim_model;
+  sim_model.setStartDate(2020, 4, 1);
+  Location& home = sim_model.createLocation(0.7, "Home");
+  for (int i = 0; i < 10; ++i) {
+    sim_model.createPerson(home, 4*24h, 7*24h);
+  }
+
+  auto ring = std::make_shared<RingBufferReportSink>(3);
+  sim_model.setKeepDailyReports(false);
+  sim_model.addReportSink(ring);
+  // The model flushes the file sinks at the end of the run.
+  ScratchFile csv_file("reports.csv");
+  ScratchFile binary_file("reports.bin");
+  sim_model.addReportSink(std::make_shared<CsvReportSink>(csv_file.path()));
+  sim_model.addReportSink(std::make_shared<BinaryReportSink>(
+      binary_file.path(), 2));
+  sim_model.simulate(5*24h);
+
+  // A header with the states of the disease model and a row per report.
+  std::string expected_header = "time";
+  for (auto name : DiseaseModel::state_names) {
+    expected_header += std::string(",") + name;
+  }
+  std::ifstream csv(csv_file.path());
+  std::string header;
+  std::getline(csv, header);
+  int rows = 0;
+  for (std::string line; std::getline(csv, line);) {
+    rows++;
+  }
+  bool csv_ok = (header == expected_header) && (rows == 5);
+
+  // The file header, and blocks of two, two and one reports with a time and
+  // a count per state each.
+  const size_t row_size = sizeof(int64_t) +
+                          DiseaseModel::num_states * sizeof(uint32_t);
+  const size_t expected_size = 16 + 3 * sizeof(uint32_t) + 5 * row_size;
+  std::ifstream binary(binary_file.path(),
+                      std::ios::binary | std::ios::ate);
+  bool binary_ok = static_cast<size_t>(binary.tellg()) == expected_size;
+
+  // Failing writes are reported.
+  bool failure_reported = false;
+  try {
+    CsvReportSink full("/dev/full");
+    full.write(sim_model.currentTime(), ring->report(2));
+    full.flush();
+  } catch (const std::runtime_error&) {
+    failure_reported = true;
+  }
+
+  // A sink that fails in the middle of a run leaves the model idle, so it can
+  // be checkpointed again.
+  Model failing_model;
+  Location& room = failing_model.createLocation(0.7, "Room");
+  failing_model.createPerson(room, 4*24h, 7*24h);
+  failing_model.addReportSink(std::make_shared<CsvReportSink>("/dev/full", 1));
+  ScratchFile checkpoint_file("checkpoint.bin");
+  bool idle = true;
+  for (bool fixed_step : {false, true}) {
+    try {
+      if (fixed_step) {
+        failing_model.simulateFixedStep(3*24h, 1h);
+      } else {
+        failing_model.simulate(3*24h);
+      }
+      idle = false;
+    } catch (const std::runtime_error&) {
+    }
+    idle &= !failing_model.fixedStepRunning();
+    try {
+      failing_model.saveCheckpoint(checkpoint_file.path());
+    } catch (const std::logic_error&) {
+      idle = false;
+    }
+  }
+
+  // A binary sink needs room for at least one report per block.
+  bool empty_block_refused = false;
+  try {
+    BinaryReportSink empty_block(binary_file.path(), 0);
+  } catch (const std::invalid_argument&) {
+    empty_block_refused = true;
+  }
+
+  std::cout << "kept: " << sim_model.dailyReports().size
+            << " ring: " << ring->size() << " susceptible: "
+            << ring->report(2).susceptible << " csv: " << csv_ok
+            << " binary: " << binary_ok << " failure: " << failure_reported
+            << " idle: " << idle << " empty block: " << empty_block_refused
+            << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,83 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <iostream>
+#include "epideux/epideux.h"
+#include "scratch_file.h"
+
+int main(int argc, char const *argv[]) {
+  using namespace epideux;
+  using namespace std::chrono_literals;
+
+  ScratchFile scenario_file("scenario.bin");
+  {
+    Model sim_model;
+    sim_model.setStartDate(2020, 4, 1);
+
+    Location& location1 = sim_model.createLocation(0.7, "Location1");
+    Location& location2 = sim_model.createLocation(0.7, "Location2");
+
+    time_pt start_time = sim_model.currentTime() + 1h;
+    ItineraryEntry loc2_it(location2, start_time, start_time + 2h);
+    for (int i = 0; i < 10; ++i) {
+      Person& my_person = sim_model.createPerson(location1, 4*24h, 7*24h);
+      my_person.addItineraryEntry(loc2_it);
+    }
+    sim_model.getPerson(3).infect();
+    sim_model.saveScenario(scenario_file.path());
+  }
+
+  Model sim_model;
+  sim_model.loadScenario(scenario_file.path());
+  Location& location1 = sim_model.getPerson(0).home();
+  Location& location2 = sim_model.getPerson(0).itinerary().front().location();
+
+  std::cout << location1.name() << '/' << location2.name() << ": "
+            << location1.getPersons().size() << '/'
+            << location2.getPersons().size();
+
+  sim_model.simulate(2h);
+
+  std::cout << " (2h) ";
+  std::cout << location1.getPersons().size() << '/'
+            << location2.getPersons().size();
+
+  SeirReport report = sim_model.getReport();
+  std::cout << " susceptible: " << report.susceptible;
+
+  // The persons keep the state they were saved in, also past the first
+  // infected state.
+  InfectionCategory saved_state;
+  {
+    Model state_model;
+    Location& home = state_model.createLocation(0.0, "Home");
+    state_model.createPerson(home, 1h, 10*24h).infect();
+    state_model.createPerson(home, 1h, 10*24h);
+    state_model.simulate(2*24h);
+    saved_state = state_model.getPerson(0).infectionState();
+    state_model.saveScenario(scenario_file.path());
+  }
+  Model state_model;
+  state_model.loadScenario(scenario_file.path());
+  SeirReport counts = state_model.getLocation(0).counts();
+  std::cout << " state: "
+            << (state_model.getPerson(0).infectionState() == saved_state)
+            << (isInfectious(saved_state) ? 1 : 0)
+            << (reportCount(counts, saved_state) == 1) << std::endl;
+
+  return 0;
+}
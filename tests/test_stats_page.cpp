@@ -0,0 +1,97 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <unistd.h>
+
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "epideux/epideux.h"
+#include "epideux/stats_page.h"
+
+int main(int argc, char const *argv[]) {
+  using namespace epideux;
+  using namespace std::chrono_literals;
+
+  constexpr uint32_t kNumPersons = 2000;
+  Model sim_model;
+  sim_model.setStartDate(2020, 4, 1);
+  Location& home = sim_model.createLocation(0.5, "Home");
+  Location& work = sim_model.createLocation(0.5, "Work");
+  time_pt now = sim_model.currentTime();
+  for (uint32_t i = 0; i < kNumPersons; ++i) {
+    Person& p = sim_model.createPerson(home, 3*24h, 5*24h);
+    for (int day = 0; day < 30; ++day) {
+      p.addItineraryEntry(
+          ItineraryEntry(work, now + day * 24h + 8h, now + day * 24h + 16h));
+    }
+  }
+  sim_model.getPerson(0).infect();
+
+  std::string name = "/epideux_test_" + std::to_string(getpid());
+  auto page = std::make_shared<StatsPage>(name, 1ms);
+  sim_model.setStatsPage(page);
+  StatsPageReader reader(name);
+
+  // A reader polls the page during the run. Every copy it gets must be
+  // consistent, i.e., the counts add up to the population.
+  std::atomic<bool> done{false};
+  uint64_t reads = 0;
+  bool consistent = true;
+  std::thread watcher([&] {
+    while (!done.load()) {
+      StatsPageData data;
+      if (reader.read(data)) {
+        uint32_t total = 0;
+        for (uint32_t s = 0; s < data.num_states; ++s) {
+          total += data.report[s];
+        }
+        consistent &= (data.num_persons == kNumPersons) &&
+                      ((total == kNumPersons) || (total == 0));
+        ++reads;
+      }
+    }
+  });
+  sim_model.simulate(30*24h);
+  done = true;
+  watcher.join();
+
+  StatsPageData data;
+  bool ok = reader.read(data) && consistent && (reads > 0) &&
+            (data.running == 0) && (data.events == 30 * 2 * kNumPersons + 31) &&
+            (data.schedule_depth == 0) && (data.resident_bytes > 0) &&
+            (data.sim_time ==
+             std::chrono::duration_cast<std::chrono::nanoseconds>(
+                 sim_model.currentTime().time_since_epoch())
+                 .count()) &&
+            (data.report[0] == sim_model.getReport().susceptible);
+
+  // The segment is removed with the page.
+  sim_model.setStatsPage(nullptr);
+  page.reset();
+  bool removed = false;
+  try {
+    StatsPageReader gone(name);
+  } catch (const std::runtime_error&) {
+    removed = true;
+  }
+  std::cout << "ok: " << (ok && removed) << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,93 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <iostream>
+#include <stdexcept>
+#include "epideux/epideux.h"
+#include "epideux/transmission_log.h"
+#include "scratch_file.h"
+
+int main(int argc, char const *argv[]) {
+  using namespace epideux;
+  using namespace std::chrono_literals;
+
+  // Two households share a workplace, so the infections happen at several
+  // locations. Small chunks make the log span several of them.
+  Model sim_model;
+  sim_model.setStartDate(2020, 4, 1);
+  auto transmission_log = std::make_shared<TransmissionLog>(4);
+  sim_model.setTransmissionLog(transmission_log);
+  Location& work = sim_model.createLocation(5.0, "Work");
+  time_pt now = sim_model.currentTime();
+  for (int h = 0; h < 2; ++h) {
+    Location& home = sim_model.createLocation(5.0, "Home");
+    for (int i = 0; i < 6; ++i) {
+      Person& p = sim_model.createPerson(home, 1*24h, 3*24h);
+      for (int day = 0; day < 20; ++day) {
+        time_pt start = now + day*24h + 8h;
+        p.addItineraryEntry(ItineraryEntry(work, start, start + 8h));
+      }
+    }
+  }
+  sim_model.getPerson(0).infect();
+  sim_model.simulate(60*24h);
+
+  // Every infection but the seed is captured, and the first one is attributed
+  // to the seed. Every infection is attributed to somebody else who was
+  // infectious at the same location.
+  SeirReport report = sim_model.getReport();
+  const TransmissionLog& records = *transmission_log;
+  bool captured = records.size() == 12 - report.susceptible - 1;
+  bool seed = (records.size() > 0) && (records[0].infector == 0);
+  bool attributed = true;
+  bool local = true;
+  for (size_t i = 0; i < records.size(); ++i) {
+    const TransmissionRecord& r = records[i];
+    attributed &= (r.infector != kNoInfector) && (r.infector != r.victim) &&
+                  (r.num_infectious > 0);
+    if (r.infector == kNoInfector) {
+      continue;
+    }
+    // Only the residents meet at a home.
+    local &= (r.location == work.id()) ||
+             ((sim_model.getPerson(r.victim).home().id() == r.location) &&
+              (sim_model.getPerson(r.infector).home().id() == r.location));
+  }
+  ScratchFile edge_list("transmissions.csv");
+  ScratchFile binary("transmissions.bin");
+  transmission_log->exportEdgeList(edge_list.path());
+  transmission_log->exportBinary(binary.path());
+
+  // A full disk is reported rather than leaving a truncated log.
+  int failures = 0;
+  try {
+    transmission_log->exportEdgeList("/dev/full");
+  } catch (const std::runtime_error&) {
+    failures++;
+  }
+  try {
+    transmission_log->exportBinary("/dev/full");
+  } catch (const std::runtime_error&) {
+    failures++;
+  }
+
+  std::cout << "captured: " << captured << " seed: " << seed
+            << " attributed: " << attributed << " local: " << local
+            << " failures: " << failures << std::endl;
+
+  return 0;
+}
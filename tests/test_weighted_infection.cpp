@@ -0,0 +1,75 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <iostream>
+#include "epideux/epideux.h"
+#include "epideux/transmission_log.h"
+
+using namespace epideux;
+using namespace std::chrono_literals;
+
+// Every third person cannot be infected and every fifth cannot infect
+// anybody. The others crowd a location with a high beta at staggered times,
+// so the draws outnumber the persons that can be infected.
+//
+// @returns The number of persons with zero susceptibility that got infected.
+uint32_t run(bool fixed_step, uint64_t seed) {
+  Model sim_model;
+  sim_model.setStartDate(2020, 4, 1);
+  sim_model.seed(seed);
+  sim_model.setTransmissionLog(std::make_shared<TransmissionLog>(64));
+  Location& home = sim_model.createLocation(1.0, "Home");
+  Location& hall = sim_model.createLocation(50000.0, "Hall");
+  for (uint32_t i = 0; i < 40; ++i) {
+    Person& p = sim_model.createPerson(home, 1h, 10*24h);
+    // Weights that are not exact in binary leave rounding in the sums.
+    p.setSusceptibility(i % 3 == 0 ? 0.0 : 0.1 * (1 + i % 7));
+    p.setInfectiousness(i % 5 == 0 ? 0.0 : 0.3 * (1 + i % 4));
+    for (int day = 0; day < 5; ++day) {
+      time_pt start = sim_model.currentTime() + day*24h + 8h + (i % 8)*10min;
+      p.addItineraryEntry(ItineraryEntry(hall, start, start + 6h));
+    }
+  }
+  for (uint32_t i = 1; i < 40; i += 6) {
+    sim_model.getPerson(i).infect();
+  }
+  if (fixed_step) {
+    sim_model.simulateFixedStep(6*24h, 15min);
+  } else {
+    sim_model.simulate(6*24h);
+  }
+
+  uint32_t immune_infected = 0;
+  for (uint32_t i = 0; i < 40; i += 3) {
+    immune_infected += !isSusceptible(sim_model.getPerson(i).infectionState());
+  }
+  return immune_infected;
+}
+
+int main(int argc, char const *argv[]) {
+  uint32_t event = 0;
+  uint32_t fixed = 0;
+  for (uint64_t seed = 1; seed <= 20; ++seed) {
+    event += run(false, seed);
+    fixed += run(true, seed);
+  }
+
+  std::cout << "immune infected event/fixed: " << event << '/' << fixed
+            << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,96 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+#include "epideux/disease_model.h"
+#include "epideux/stats_page.h"
+
+// Watches the stats page of a running model and prints a line per interval
+// until the run ends.
+int main(int argc, char const *argv[]) {
+  using namespace epideux;
+
+  if ((argc < 2) || (argc > 3)) {
+    std::cerr << "Please provide [page name] [interval in seconds, 0 to print "
+                 "once]"
+              << std::endl;
+    return -1;
+  }
+  double interval = argc == 3 ? std::atof(argv[2]) : 1.0;
+
+  std::unique_ptr<StatsPageReader> reader;
+  try {
+    reader = std::make_unique<StatsPageReader>(argv[1]);
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return -1;
+  }
+
+  bool seen_running = false;
+  for (;;) {
+    StatsPageData data;
+    if (reader->read(data)) {
+      std::time_t t = data.sim_time / 1000000000;
+      std::tm tm;
+      localtime_r(&t, &tm);
+      char sim_time[32];
+      std::strftime(sim_time, sizeof(sim_time), "%Y-%m-%d %H:%M:%S", &tm);
+      double age =
+          std::chrono::duration<double>(
+              std::chrono::system_clock::now().time_since_epoch())
+              .count() -
+          data.wall_time * 1e-9;
+      std::cout << sim_time << "  events " << data.events << "  events/s "
+                << uint64_t(data.events_per_second) << "  schedule "
+                << data.schedule_depth << "  memory "
+                << data.resident_bytes / (1024 * 1024) << " MB ";
+      for (uint32_t s = 0; (s < data.num_states) && (s < kStatsPageMaxStates);
+           ++s) {
+        std::cout << ' '
+                  << (data.num_states == DiseaseModel::num_states
+                          ? DiseaseModel::state_names[s]
+                          : "state")
+                  << ' ' << data.report[s];
+      }
+      if (!data.running) {
+        std::cout << "  (stopped)";
+      } else if (age > 5.0 * std::max(interval, 1.0)) {
+        // The model publishes several times per second while it runs.
+        std::cout << "  (no update for " << uint64_t(age) << " s)";
+      }
+      std::cout << std::endl;
+      seen_running |= data.running != 0;
+      if (seen_running && !data.running) {
+        break;
+      }
+    }
+    if (interval <= 0.0) {
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(interval));
+  }
+
+  return 0;
+}
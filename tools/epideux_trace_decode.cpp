@@ -0,0 +1,79 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include "epideux/disease_model.h"
+#include "epideux/event_trace.h"
+
+// Decodes a binary event trace into CSV on the standard output.
+int main(int argc, char const *argv[]) {
+  using namespace epideux;
+
+  if (argc != 2) {
+    std::cerr << "Please provide [trace file]" << std::endl;
+    return -1;
+  }
+  FILE* file = std::fopen(argv[1], "rb");
+  if (file == nullptr) {
+    std::cerr << "Could not open " << argv[1] << std::endl;
+    return -1;
+  }
+
+  TraceFileHeader header;
+  if ((std::fread(&header, sizeof(header), 1, file) != 1) ||
+      (std::memcmp(header.magic, kTraceMagic, sizeof(kTraceMagic)) != 0) ||
+      (header.version != kTraceVersion) ||
+      (header.record_size != sizeof(TraceRecord))) {
+    std::cerr << "Not a trace file " << argv[1] << std::endl;
+    std::fclose(file);
+    return -1;
+  }
+  // The states are only named for the disease model the trace was made with.
+  if (header.num_states != DiseaseModel::num_states) {
+    std::cerr << "The trace has " << header.num_states
+              << " states, but this build has " << DiseaseModel::num_states
+              << std::endl;
+    std::fclose(file);
+    return -1;
+  }
+
+  const char* kind_names[] = {"move", "begin_itinerary_entry",
+                              "end_itinerary_entry", "infection",
+                              "state_change"};
+  std::cout << "time_ns,kind,person,location,state\n";
+  TraceRecord records[4096];
+  size_t read;
+  while ((read = std::fread(records, sizeof(TraceRecord), 4096, file)) > 0) {
+    for (size_t i = 0; i < read; ++i) {
+      const TraceRecord& r = records[i];
+      size_t kind = static_cast<size_t>(r.kind);
+      std::cout << r.time << ','
+                << (kind < 5 ? kind_names[kind] : "unknown") << ','
+                << r.person << ',' << r.location << ','
+                << (r.state < DiseaseModel::num_states
+                        ? DiseaseModel::state_names[r.state]
+                        : "unknown")
+                << '\n';
+    }
+  }
+  std::fclose(file);
+
+  return 0;
+}
@@ -0,0 +1,700 @@
+// Epideux - Agent Based Location-Graph Epidemic Simulation
+//
+// Copyright (C) 2020  Karl D. Hansen, Aalborg University <kdh@es.aau.dk>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+// Statistical validation of the engine.
+//
+// Runs reference scenarios many times with every engine configuration and
+// compares the distributions of the attack rate, the peak time and the peak
+// height with two-sample Kolmogorov-Smirnov and Anderson-Darling tests.
+//
+// A change is validated by comparing the build after it with the samples of
+// the build before it, saved with --save-baseline, using --baseline. Every
+// configuration is then compared with itself, and any shift in the dynamics
+// fails the validation, as does a configuration missing from the baseline.
+// The validate target compares with the baseline kept in the source tree. The
+// well-mixed scenario is also compared with the solution of the SEIR
+// equations.
+//
+// The engine configurations are compared with the event engine as well, but
+// only for information: they integrate time differently, e.g., the event
+// engine evaluates a location nobody leaves only at the daily reports, so
+// they are not expected to agree exactly.
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "epideux/epideux.h"
+
+using namespace epideux;
+using namespace std::chrono_literals;
+
+namespace {
+
+const char* const engine_names[] = {"event", "exposure", "fixed"};
+
+constexpr time_duration kIncubation = 3*24h;
+constexpr time_duration kDisease = 5*24h;
+
+struct Options {
+  std::vector<std::string> scenarios = {"single_home", "two_age",
+                                        "household_school"};
+  std::vector<std::string> engines = {"event", "exposure", "fixed"};
+  int replicates = 200;
+  unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+  uint64_t seed = 1;
+  double alpha = 0.001;
+  std::string save_baseline;
+  std::string baseline;
+};
+
+enum Metric { AttackRate, PeakTime, PeakHeight, NumMetrics };
+const char* metric_names[NumMetrics] = {"attack_rate", "peak_time",
+                                        "peak_height"};
+
+struct Outcome {
+  double metrics[NumMetrics];
+};
+
+struct ScenarioSpec {
+  const char* name;
+  int days;
+  // Builds the scenario and returns the number of persons.
+  uint32_t (*build)(Model& sim_model, int days);
+};
+
+// Everybody in one location, as in the single_home example. This is the
+// well-mixed case that the SEIR equations describe.
+constexpr uint32_t kSingleHomePersons = 1000;
+constexpr double kSingleHomeBeta = 0.5;
+constexpr uint32_t kSingleHomeInfected = 10;
+
+uint32_t buildSingleHome(Model& sim_model, int /* days */) {
+  Location& home = sim_model.createLocation(kSingleHomeBeta, "Home");
+  for (uint32_t i = 0; i < kSingleHomePersons; ++i) {
+    sim_model.createPerson(home, kIncubation, kDisease);
+  }
+  for (uint32_t i = 0; i < kSingleHomeInfected; ++i) {
+    sim_model.getPerson(i).infect();
+  }
+  return kSingleHomePersons;
+}
+
+// The old stay at home, the young visit them every day for the second half
+// of the run, as in the two_age example.
+uint32_t buildTwoAge(Model& sim_model, int days) {
+  constexpr uint32_t kOld = 500;
+  constexpr uint32_t kYoung = 500;
+  Location& old_home = sim_model.createLocation(0.5, "Old");
+  Location& young_home = sim_model.createLocation(0.5, "Young");
+  for (uint32_t i = 0; i < kOld; ++i) {
+    sim_model.createPerson(old_home, kIncubation, kDisease);
+  }
+  time_pt now = sim_model.currentTime();
+  for (uint32_t i = 0; i < kYoung; ++i) {
+    Person& person = sim_model.createPerson(young_home, kIncubation, kDisease);
+    for (time_pt t = now + (days / 2) * 24h; t < now + days * 24h; t += 24h) {
+      person.addItineraryEntry(ItineraryEntry(old_home, t, t + 2h));
+    }
+  }
+  for (uint32_t i = 0; i < 5; ++i) {
+    sim_model.getPerson(kOld + i).infect();
+  }
+  return kOld + kYoung;
+}
+
+// Households of four, where the children go to school on weekdays.
+uint32_t buildHouseholdSchool(Model& sim_model, int days) {
+  constexpr uint32_t kHouseholds = 500;
+  constexpr uint32_t kSchools = 4;
+  std::vector<Location*> schools;
+  for (uint32_t i = 0; i < kSchools; ++i) {
+    schools.push_back(&sim_model.createLocation(1.0, "School"));
+  }
+  time_pt day0 = sim_model.currentTime();
+  for (uint32_t h = 0; h < kHouseholds; ++h) {
+    Location& home = sim_model.createLocation(2.0);
+    Location& school = *schools[h % kSchools];
+    for (int i = 0; i < 4; ++i) {
+      Person& person = sim_model.createPerson(home, kIncubation, kDisease);
+      if (i < 2) {
+        continue;
+      }
+      for (int d = 0; d < days; ++d) {
+        if (d % 7 < 5) {
+          time_pt day = day0 + d * 24h;
+          person.addItineraryEntry(ItineraryEntry(school, day + 8h, day + 15h));
+        }
+      }
+    }
+  }
+  for (uint32_t i = 0; i < 10; ++i) {
+    sim_model.getPerson(i * 4 * 50 + 2).infect();
+  }
+  return 4 * kHouseholds;
+}
+
+const ScenarioSpec scenario_specs[] = {
+    {"single_home", 150, buildSingleHome},
+    {"two_age", 120, buildTwoAge},
+    {"household_school", 120, buildHouseholdSchool}};
+
+const ScenarioSpec& findScenario(const std::string& name) {
+  for (const auto& spec : scenario_specs) {
+    if (name == spec.name) {
+      return spec;
+    }
+  }
+  throw std::invalid_argument("Unknown scenario " + name);
+}
+
+uint32_t numInfectious(const SeirReport& report) {
+  uint32_t count = 0;
+  for (size_t s = 0; s < DiseaseModel::num_states; ++s) {
+    if (DiseaseModel::infectious[s]) {
+      count += reportCount(report, s);
+    }
+  }
+  return count;
+}
+
+uint32_t numSusceptible(const SeirReport& report) {
+  uint32_t count = 0;
+  for (size_t s = 0; s < DiseaseModel::num_states; ++s) {
+    if (DiseaseModel::susceptible[s]) {
+      count += reportCount(report, s);
+    }
+  }
+  return count;
+}
+
+///
+/// Get the metrics of an epidemic from its daily number of infectious and
+/// the final number of susceptible.
+///
+Outcome summarize(const std::vector<double>& infectious, double susceptible,
+                  double num_persons) {
+  Outcome outcome;
+  auto peak = std::max_element(infectious.begin(), infectious.end());
+  outcome.metrics[AttackRate] = 1.0 - susceptible / num_persons;
+  outcome.metrics[PeakTime] = peak - infectious.begin();
+  outcome.metrics[PeakHeight] = *peak / num_persons;
+  return outcome;
+}
+
+Outcome runOnce(const ScenarioSpec& spec, const std::string& engine,
+                uint64_t seed) {
+  Model sim_model;
+  sim_model.setStartDate(2020, 4, 1);
+  sim_model.seed(seed);
+  if (engine == "exposure") {
+    sim_model.setTransmissionModel(TransmissionModel::ExposureAccumulation);
+  }
+  uint32_t num_persons = spec.build(sim_model, spec.days);
+  if (engine == "fixed") {
+    sim_model.simulateFixedStep(spec.days * 24h, 15min);
+  } else {
+    sim_model.simulate(spec.days * 24h);
+  }
+  std::vector<double> infectious;
+  for (const auto& report : sim_model.dailyReports()) {
+    infectious.push_back(numInfectious(report));
+  }
+  return summarize(infectious, numSusceptible(sim_model.getReport()),
+                   num_persons);
+}
+
+///
+/// Solve the SEIR equations of the single_home scenario.
+///
+/// The persons stay in each compartment for a fixed time, so the equations
+/// have delays rather than exponential rates: a person exposed at time t is
+/// infectious from t + a to t + b, where a and b follow from the transitions
+/// of the disease model. The incidence beta * S * I / N is integrated with a
+/// step of a minute.
+///
+Outcome solveSingleHome(int days) {
+  DiseaseDurations durations =
+      DiseaseModel::makeDurations(kIncubation, kDisease);
+  time_duration begin = time_duration::zero();
+  time_duration end = time_duration::zero();
+  size_t state = stateIndex(DiseaseModel::infected_state);
+  for (size_t steps = 0; steps < DiseaseModel::num_states; ++steps) {
+    const auto& transition = DiseaseModel::transitions[state];
+    if ((transition.duration == kNoTransition) ||
+        (durations[transition.duration] == time_duration::max())) {
+      break;
+    }
+    time_duration duration = durations[transition.duration];
+    if (DiseaseModel::infectious[state]) {
+      end += duration;
+    } else if (end == begin) {
+      begin += duration;
+      end += duration;
+    }
+    state = stateIndex(transition.next);
+  }
+
+  constexpr int kStepsPerDay = 24 * 60;
+  double dt = 1.0 / kStepsPerDay;
+  size_t delay_begin = std::chrono::duration_cast<std::chrono::minutes>(begin)
+                           .count();
+  size_t delay_end =
+      std::chrono::duration_cast<std::chrono::minutes>(end).count();
+  size_t num_steps = size_t(days) * kStepsPerDay;
+  // The persons exposed in each step.
+  std::vector<double> exposed(num_steps + 1, 0.0);
+  exposed[0] = kSingleHomeInfected;
+  double susceptible = kSingleHomePersons - kSingleHomeInfected;
+  double infectious = 0.0;
+  std::vector<double> daily_infectious;
+  for (size_t k = 0; k < num_steps; ++k) {
+    if (k >= delay_begin) {
+      infectious += exposed[k - delay_begin];
+    }
+    if (k >= delay_end) {
+      infectious -= exposed[k - delay_end];
+    }
+    if (k % kStepsPerDay == 0) {
+      daily_infectious.push_back(infectious);
+    }
+    double incidence =
+        kSingleHomeBeta * susceptible * infectious / kSingleHomePersons * dt;
+    incidence = std::min(incidence, susceptible);
+    susceptible -= incidence;
+    exposed[k + 1] += incidence;
+  }
+  return summarize(daily_infectious, susceptible, kSingleHomePersons);
+}
+
+struct TestResult {
+  double statistic;
+  double p_value;
+};
+
+///
+/// Two-sample Kolmogorov-Smirnov test with the asymptotic p-value.
+///
+TestResult kolmogorovSmirnov(std::vector<double> a, std::vector<double> b) {
+  std::sort(a.begin(), a.end());
+  std::sort(b.begin(), b.end());
+  double d = 0.0;
+  size_t i = 0;
+  size_t j = 0;
+  while ((i < a.size()) && (j < b.size())) {
+    double x = std::min(a[i], b[j]);
+    while ((i < a.size()) && (a[i] == x)) {
+      ++i;
+    }
+    while ((j < b.size()) && (b[j] == x)) {
+      ++j;
+    }
+    d = std::max(d, std::abs(double(i) / a.size() - double(j) / b.size()));
+  }
+  double en = std::sqrt(double(a.size()) * b.size() / (a.size() + b.size()));
+  double lambda = (en + 0.12 + 0.11 / en) * d;
+  if (lambda < 0.3) {
+    return {d, 1.0};
+  }
+  double p = 0.0;
+  double sign = 1.0;
+  for (int k = 1; k <= 100; ++k) {
+    double term = sign * 2.0 * std::exp(-2.0 * k * k * lambda * lambda);
+    p += term;
+    if (std::abs(term) < 1e-12) {
+      break;
+    }
+    sign = -sign;
+  }
+  return {d, std::clamp(p, 0.0, 1.0)};
+}
+
+///
+/// Two-sample Anderson-Darling test of Scholz and Stephens (1987), in the
+/// version that allows ties. The statistic is standardized, and the p-value
+/// is interpolated from their table of critical values, so it is clipped to
+/// [0.001, 0.25].
+///
+TestResult andersonDarling(std::vector<double> a, std::vector<double> b) {
+  std::sort(a.begin(), a.end());
+  std::sort(b.begin(), b.end());
+  std::vector<double> z(a);
+  z.insert(z.end(), b.begin(), b.end());
+  std::sort(z.begin(), z.end());
+  double n_total = z.size();
+  const std::vector<double>* samples[2] = {&a, &b};
+
+  double a2 = 0.0;
+  for (const auto* sample : samples) {
+    double n = sample->size();
+    double inner = 0.0;
+    for (size_t j = 0; j < z.size();) {
+      double value = z[j];
+      size_t below = j;
+      while ((j < z.size()) && (z[j] == value)) {
+        ++j;
+      }
+      double l = j - below;
+      double b_mid = below + l / 2.0;
+      auto range = std::equal_range(sample->begin(), sample->end(), value);
+      double m_mid = (range.first - sample->begin()) +
+                     (range.second - range.first) / 2.0;
+      double denominator = b_mid * (n_total - b_mid) - n_total * l / 4.0;
+      if (denominator > 0.0) {
+        double diff = n_total * m_mid - n * b_mid;
+        inner += l / n_total * diff * diff / denominator;
+      }
+    }
+    a2 += inner / n;
+  }
+  a2 *= (n_total - 1.0) / n_total;
+
+  // The variance of the statistic under the null hypothesis.
+  double k = 2.0;
+  double big_h = 1.0 / a.size() + 1.0 / b.size();
+  size_t n_int = z.size();
+  std::vector<double> harmonic(n_int, 0.0);
+  for (size_t i = 1; i < n_int; ++i) {
+    harmonic[i] = harmonic[i - 1] + 1.0 / i;
+  }
+  double h = harmonic[n_int - 1];
+  double g = 0.0;
+  for (size_t i = 1; i + 1 < n_int; ++i) {
+    g += (h - harmonic[i]) / (n_total - i);
+  }
+  double coef_a = (4 * g - 6) * (k - 1) + (10 - 6 * g) * big_h;
+  double coef_b = (2 * g - 4) * k * k + 8 * h * k +
+                  (2 * g - 14 * h - 4) * big_h - 8 * h + 4 * g - 6;
+  double coef_c = (6 * h + 2 * g - 2) * k * k + (4 * h - 4 * g + 6) * k +
+                  (2 * h - 6) * big_h + 4 * h;
+  double coef_d = (2 * h + 4) * k * k - 4 * h * k;
+  double n = n_total;
+  double variance =
+      (coef_a * n * n * n + coef_b * n * n + coef_c * n + coef_d) /
+      ((n - 1) * (n - 2) * (n - 3));
+  double t = (a2 - (k - 1)) / std::sqrt(variance);
+
+  // Critical values for two samples.
+  const double critical[] = {0.325, 1.226, 1.961, 2.718, 3.752, 4.592, 6.546};
+  const double levels[] = {0.25, 0.1, 0.05, 0.025, 0.01, 0.005, 0.001};
+  constexpr size_t kNumLevels = 7;
+  if (t <= critical[0]) {
+    return {t, levels[0]};
+  }
+  for (size_t i = 1; i < kNumLevels; ++i) {
+    if (t <= critical[i]) {
+      double f = (t - critical[i - 1]) / (critical[i] - critical[i - 1]);
+      return {t, std::exp(std::log(levels[i - 1]) +
+                          f * (std::log(levels[i]) - std::log(levels[i - 1])))};
+    }
+  }
+  return {t, levels[kNumLevels - 1]};
+}
+
+double mean(const std::vector<double>& values) {
+  double sum = 0.0;
+  for (double v : values) {
+    sum += v;
+  }
+  return values.empty() ? 0.0 : sum / values.size();
+}
+
+typedef std::map<std::string, std::vector<double>> Samples;
+
+std::string sampleKey(const std::string& scenario, const std::string& engine,
+                      int metric) {
+  return scenario + " " + engine + " " + metric_names[metric];
+}
+
+void saveSamples(const std::string& path, const Samples& samples) {
+  std::ofstream out(path);
+  out << std::setprecision(17);
+  for (const auto& [key, values] : samples) {
+    out << key;
+    for (double v : values) {
+      out << ' ' << v;
+    }
+    out << '\n';
+  }
+  if (!out) {
+    throw std::runtime_error("Could not write " + path);
+  }
+}
+
+Samples loadSamples(const std::string& path) {
+  std::ifstream in(path);
+  if (!in) {
+    throw std::runtime_error("Could not read " + path);
+  }
+  Samples samples;
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream fields(line);
+    std::string scenario, engine, metric;
+    fields >> scenario >> engine >> metric;
+    auto& values = samples[scenario + " " + engine + " " + metric];
+    double v;
+    while (fields >> v) {
+      values.push_back(v);
+    }
+  }
+  return samples;
+}
+
+///
+/// Compare two samples with both tests and print a line.
+///
+/// @returns Whether the samples pass, i.e., neither test rejects them being
+/// drawn from the same distribution at the significance level alpha.
+///
+bool compare(const std::string& what, const std::vector<double>& sample,
+             const std::vector<double>& reference, double alpha,
+             bool informational) {
+  TestResult ks = kolmogorovSmirnov(sample, reference);
+  TestResult ad = andersonDarling(sample, reference);
+  bool pass = (ks.p_value >= alpha) && (ad.p_value >= alpha);
+  const char* verdict = pass ? "" : (informational ? "  differs" : "  FAIL");
+  std::cout << "  " << std::left << std::setw(34) << what << std::right
+            << std::fixed << std::setprecision(4) << " mean " << std::setw(9)
+            << mean(sample) << " vs " << std::setw(9) << mean(reference)
+            << "  KS p " << std::setw(6) << ks.p_value << "  AD p "
+            << std::setw(6) << ad.p_value << verdict << std::endl;
+  return pass;
+}
+
+void usage() {
+  std::cerr
+      << "Usage: epideux_validate [options]\n"
+         "  --scenario NAME       single_home, two_age or household_school;\n"
+         "                        repeatable\n"
+         "  --engine NAME         event, exposure or fixed; repeatable\n"
+         "  --replicates N        runs per scenario and engine (default 200)\n"
+         "  --threads N           parallel runs (default: all cores)\n"
+         "  --seed N              first random seed (default 1)\n"
+         "  --alpha X             significance level (default 0.001)\n"
+         "  --save-baseline FILE  write the samples to FILE\n"
+         "  --baseline FILE       compare with the samples in FILE\n";
+}
+
+}  // namespace
+
+int main(int argc, char const *argv[]) {
+  Options options;
+  bool scenario_given = false;
+  bool engine_given = false;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if ((arg == "--help") || (arg == "-h")) {
+      usage();
+      return 0;
+    }
+    if (i + 1 >= argc) {
+      usage();
+      return 1;
+    }
+    std::string value = argv[++i];
+    if (arg == "--scenario") {
+      if (!scenario_given) {
+        options.scenarios.clear();
+        scenario_given = true;
+      }
+      options.scenarios.push_back(value);
+    } else if (arg == "--engine") {
+      if (std::find(std::begin(engine_names), std::end(engine_names),
+                    value) == std::end(engine_names)) {
+        std::cerr << "Unknown engine " << value << std::endl;
+        return 1;
+      }
+      if (!engine_given) {
+        options.engines.clear();
+        engine_given = true;
+      }
+      options.engines.push_back(value);
+    } else if (arg == "--replicates") {
+      options.replicates = std::atoi(value.c_str());
+    } else if (arg == "--threads") {
+      options.threads = std::max(1, std::atoi(value.c_str()));
+    } else if (arg == "--seed") {
+      options.seed = std::strtoull(value.c_str(), nullptr, 10);
+    } else if (arg == "--alpha") {
+      options.alpha = std::atof(value.c_str());
+    } else if (arg == "--save-baseline") {
+      options.save_baseline = value;
+    } else if (arg == "--baseline") {
+      options.baseline = value;
+    } else {
+      usage();
+      return 1;
+    }
+  }
+  if (options.replicates < 8) {
+    std::cerr << "Use at least 8 replicates" << std::endl;
+    return 1;
+  }
+
+  struct Job {
+    const ScenarioSpec* spec;
+    size_t engine;
+    int replicate;
+  };
+  std::vector<Job> jobs;
+  try {
+    for (const auto& scenario : options.scenarios) {
+      const ScenarioSpec& spec = findScenario(scenario);
+      for (size_t e = 0; e < options.engines.size(); ++e) {
+        for (int r = 0; r < options.replicates; ++r) {
+          jobs.push_back({&spec, e, r});
+        }
+      }
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  // The models are independent, so the runs are spread over the threads.
+  // Every engine gets its own seeds, so the samples are independent.
+  std::vector<Outcome> outcomes(jobs.size());
+  std::atomic<size_t> next_job{0};
+  auto worker = [&] {
+    for (size_t j = next_job++; j < jobs.size(); j = next_job++) {
+      const Job& job = jobs[j];
+      const std::string& engine = options.engines[job.engine];
+      uint64_t engine_index =
+          std::find(std::begin(engine_names), std::end(engine_names), engine) -
+          std::begin(engine_names);
+      outcomes[j] = runOnce(*job.spec, engine,
+                            options.seed + job.replicate +
+                                1000003 * engine_index);
+    }
+  };
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t < options.threads; ++t) {
+    threads.emplace_back(worker);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  std::cout << jobs.size() << " runs on " << options.threads << " threads in "
+            << std::fixed << std::setprecision(1) << seconds << " s"
+            << std::endl;
+
+  Samples samples;
+  for (size_t j = 0; j < jobs.size(); ++j) {
+    for (int m = 0; m < NumMetrics; ++m) {
+      samples[sampleKey(jobs[j].spec->name,
+                        options.engines[jobs[j].engine], m)]
+          .push_back(outcomes[j].metrics[m]);
+    }
+  }
+
+  bool pass = true;
+  const std::string reference_engine = "event";
+  if ((options.engines.size() > 1) &&
+      (std::find(options.engines.begin(), options.engines.end(),
+                 reference_engine) != options.engines.end())) {
+    std::cout << "Engines vs the event engine (for information):"
+              << std::endl;
+    for (const auto& scenario : options.scenarios) {
+      for (const auto& engine : options.engines) {
+        if (engine == reference_engine) {
+          continue;
+        }
+        for (int m = 0; m < NumMetrics; ++m) {
+          compare(sampleKey(scenario, engine, m),
+                  samples[sampleKey(scenario, engine, m)],
+                  samples[sampleKey(scenario, reference_engine, m)],
+                  options.alpha, true);
+        }
+      }
+    }
+  }
+
+  if (!options.baseline.empty()) {
+    Samples baseline;
+    try {
+      baseline = loadSamples(options.baseline);
+    } catch (const std::exception& e) {
+      std::cerr << e.what() << std::endl;
+      return 1;
+    }
+    std::cout << "Against the baseline:" << std::endl;
+    for (const auto& [key, values] : samples) {
+      auto it = baseline.find(key);
+      if (it == baseline.end()) {
+        std::cout << "  " << key << " is not in the baseline  FAIL"
+                  << std::endl;
+        pass = false;
+        continue;
+      }
+      pass &= compare(key, values, it->second, options.alpha, false);
+    }
+  }
+
+  // The well-mixed scenario follows the SEIR equations, apart from the
+  // stochastic fluctuations. Only the fixed-step engine resolves the time
+  // within the days in a location nobody leaves, so the event engines are
+  // compared for information.
+  if (std::find(options.scenarios.begin(), options.scenarios.end(),
+                "single_home") != options.scenarios.end()) {
+    std::cout << "Against the SEIR equations:" << std::endl;
+    Outcome expected = solveSingleHome(findScenario("single_home").days);
+    const double tolerances[NumMetrics] = {0.02, 2.0, 0.02};
+    for (const auto& engine : options.engines) {
+      bool informational = engine != "fixed";
+      for (int m = 0; m < NumMetrics; ++m) {
+        double simulated = mean(samples[sampleKey("single_home", engine, m)]);
+        bool close =
+            std::abs(simulated - expected.metrics[m]) <= tolerances[m];
+        const char* verdict =
+            close ? "" : (informational ? "  differs" : "  FAIL");
+        std::cout << "  " << std::left << std::setw(34)
+                  << sampleKey("single_home", engine, m) << std::right
+                  << std::fixed << std::setprecision(4) << " mean "
+                  << std::setw(9) << simulated << " vs " << std::setw(9)
+                  << expected.metrics[m] << verdict << std::endl;
+        pass &= close || informational;
+      }
+    }
+  }
+
+  if (!options.save_baseline.empty()) {
+    try {
+      saveSamples(options.save_baseline, samples);
+    } catch (const std::exception& e) {
+      std::cerr << e.what() << std::endl;
+      return 1;
+    }
+  }
+
+  std::cout << "validation: " << (pass ? "passed" : "failed") << std::endl;
+  return pass ? 0 : 1;
+}